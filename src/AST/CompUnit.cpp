@@ -4,25 +4,52 @@
 
 #include "CompUnit.h"
 
+#include "errorHandler/Error.h"
 #include "frontend/lexer/Lexer.h"
 #include "frontend/parser/Parser.h"
 #include "frontend/symTab/SymTab.h"
+#include "tools/Stats.h"
 
 using namespace Parser;
 
+namespace {
+bool isFuncDef() {
+    return Lexer::peek(1).first == LexType::IDENFR && Lexer::peek(2).first == LexType::LPARENT;
+}
+
+bool isMainFuncDef() {
+    return Lexer::curLexType() == LexType::INTTK && Lexer::peek(1).first == LexType::MAINTK;
+}
+
+void genGlobVars(const std::vector<std::unique_ptr<Decl>> &decls, IR::Module &module) {
+    // maybe redundant, but still set it for safety
+    SymTab::cur() = &SymTab::global();
+    SymTab::knownVars().emplace_back();
+    for (auto &decl: decls) {
+        for (auto &def: decl->getDefs()) {
+            auto sym = SymTab::find(def->ident);
+
+            auto globVar = IR::GlobVar(sym->cons, sym->dims, sym->initVal);
+            SymTab::knownVars().back().emplace(def->ident, 0);
+            module.addGlobVar(def->ident, globVar);
+        }
+    }
+}
+} // namespace
+
 std::unique_ptr<CompUnit> CompUnit::parse() {
+    Stats::Timer timer("parse");
     auto n = std::make_unique<CompUnit>();
 
-    while (Lexer::curLexType == LexType::CONSTTK || Lexer::curLexType == LexType::INTTK) {
-        if (Lexer::peek(1).first == LexType::IDENFR && Lexer::peek(2).first == LexType::LPARENT
-            || Lexer::curLexType == LexType::INTTK && Lexer::peek(1).first == LexType::MAINTK) {
+    while (Lexer::curLexType() == LexType::CONSTTK || Lexer::curLexType() == LexType::INTTK) {
+        if (isFuncDef() || isMainFuncDef()) {
             break;
         }
         n->decls.push_back(Decl::parse());
     }
 
-    while (Lexer::curLexType == LexType::VOIDTK || Lexer::curLexType == LexType::INTTK) {
-        if (Lexer::curLexType == LexType::INTTK && Lexer::peek(1).first == LexType::MAINTK) {
+    while (Lexer::curLexType() == LexType::VOIDTK || Lexer::curLexType() == LexType::INTTK) {
+        if (isMainFuncDef()) {
             break;
         }
         n->funcDefs.push_back(FuncDef::parse());
@@ -38,27 +65,77 @@ std::unique_ptr<CompUnit> CompUnit::parse() {
 std::unique_ptr<IR::Module> CompUnit::genIR() const {
     using namespace IR;
 
+    Stats::Timer timer("genIR");
     auto module = std::make_unique<Module>("Write by Steel Shadow");
-
-    // maybe redundant, but still set it for safety
-    SymTab::cur = &SymTab::global;
-    SymTab::knownVars.emplace_back();
-    for (auto &decl: decls) {
-        for (auto &def: decl->getDefs()) {
-            auto sym = SymTab::find(def->ident);
-
-            auto globVar = GlobVar(sym->cons, sym->dims, sym->initVal);
-            SymTab::knownVars.back().emplace(def->ident, 0);
-            module->addGlobVar(def->ident, globVar);
-        }
-    }
+    genGlobVars(decls, *module);
 
     for (auto &funcDef: funcDefs) {
         module->addFunction(funcDef->genIR());
     }
 
-    ReturnStmt::inMainGen = true;
+    ReturnStmt::inMainGen() = true;
     module->setMainFunction(mainFuncDef->genIR());
 
     return module;
 }
+
+void CompUnit::stream(const std::function<void(IR::Module &)> &onGlobals,
+                      const std::function<void(IR::Function &, bool isMain)> &onFunction) {
+    std::vector<std::unique_ptr<Decl>> decls;
+    {
+        Stats::Timer timer("parse");
+        while (Lexer::curLexType() == LexType::CONSTTK || Lexer::curLexType() == LexType::INTTK) {
+            if (isFuncDef() || isMainFuncDef()) {
+                break;
+            }
+            decls.push_back(Decl::parse());
+        }
+    }
+
+    IR::Module globals("Write by Steel Shadow");
+    {
+        Stats::Timer timer("genIR");
+        genGlobVars(decls, globals);
+    }
+    if (!Error::hasError()) {
+        onGlobals(globals);
+    }
+
+    while (Lexer::curLexType() == LexType::VOIDTK || Lexer::curLexType() == LexType::INTTK) {
+        if (isMainFuncDef()) {
+            break;
+        }
+        std::unique_ptr<FuncDef> funcDef;
+        {
+            Stats::Timer timer("parse");
+            funcDef = FuncDef::parse();
+        }
+        if (!Error::hasError()) {
+            std::unique_ptr<IR::Function> func;
+            {
+                Stats::Timer timer("genIR");
+                func = funcDef->genIR();
+            }
+            onFunction(*func, false);
+        }
+        SymTab::releaseScopes();
+    }
+
+    std::unique_ptr<MainFuncDef> mainFuncDef;
+    {
+        Stats::Timer timer("parse");
+        mainFuncDef = MainFuncDef::parse();
+    }
+    if (!Error::hasError()) {
+        ReturnStmt::inMainGen() = true;
+        std::unique_ptr<IR::Function> func;
+        {
+            Stats::Timer timer("genIR");
+            func = mainFuncDef->genIR();
+        }
+        onFunction(*func, true);
+    }
+    SymTab::releaseScopes();
+
+    output(AST::CompUnit);
+}
@@ -5,6 +5,7 @@
 #ifndef COMPILER_COMPUNIT_H
 #define COMPILER_COMPUNIT_H
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -21,6 +22,14 @@ struct CompUnit {
     static std::unique_ptr<CompUnit> parse();
 
     std::unique_ptr<IR::Module> genIR() const;
+
+    // streaming mode, the whole CompUnit is never built:
+    // onGlobals gets a Module with only the global variables once all Decls are parsed,
+    // onFunction gets the IR of each function right after it is parsed, in source order (main last).
+    // A function's AST, IR and local SymTabs are freed as soon as onFunction returns.
+    // After the first error, the rest is still parsed for error reporting, but not generated.
+    static void stream(const std::function<void(IR::Module &)> &onGlobals,
+                       const std::function<void(IR::Function &, bool isMain)> &onFunction);
 };
 
 #endif
@@ -13,7 +13,7 @@ using namespace Parser;
 std::unique_ptr<Decl> Decl::parse() {
     auto n = std::make_unique<Decl>();
 
-    if (Lexer::curLexType == LexType::CONSTTK) {
+    if (Lexer::curLexType() == LexType::CONSTTK) {
         Lexer::next();
         n->cons = true;
     } else {
@@ -22,12 +22,12 @@ std::unique_ptr<Decl> Decl::parse() {
 
     n->btype = Btype::parse();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     n->defs.push_back(Def::parse(n->cons, toType(n->btype->type)));
 
-    while (Lexer::curLexType == LexType::COMMA) {
+    while (Lexer::curLexType() == LexType::COMMA) {
         Lexer::next();
-        row = Lexer::curRow;
+        row = Lexer::curRow();
         n->defs.push_back(Def::parse(n->cons, toType(n->btype->type)));
     }
 
@@ -74,8 +74,8 @@ std::unique_ptr<Btype> Btype::parse() {
 std::string Ident::parse() {
     std::string ident;
 
-    if (Lexer::curLexType == LexType::IDENFR) {
-        ident = Lexer::curToken;
+    if (Lexer::curLexType() == LexType::IDENFR) {
+        ident = Lexer::curToken();
         Lexer::next();
     } else {
         Error::raise();
@@ -8,14 +8,106 @@
 #include "frontend/parser/Parser.h"
 #include "frontend/symTab/SymTab.h"
 
+#include <optional>
 
 using namespace Parser;
 
+namespace {
+// runs of an equal constant at least this long are stored by one Fill
+constexpr std::size_t MIN_FILL_RUN = 4;
+// constants without such runs are copied from .data by one CopyData if there are this many,
+// it saves code but not instructions executed, so only for big tables
+constexpr std::size_t MIN_COPY_DATA = 64;
+
+std::size_t runEnd(const std::vector<std::optional<int>> &values, std::size_t i) {
+    auto j = i + 1;
+    while (j < values.size() && values[j] == values[i]) {
+        ++j;
+    }
+    return j;
+}
+
+void store(IR::BasicBlocks &bBlocks, const IR::Var &var, std::unique_ptr<IR::Temp> value, std::size_t index) {
+    using namespace IR;
+    bBlocks.back()->addInst(Inst(
+            Op::Store,
+            std::move(value),
+            std::make_unique<Var>(var),
+            std::make_unique<ConstVal>(static_cast<int>(index), Type::Int)));
+}
+
+std::unique_ptr<IR::Temp> loadImd(IR::BasicBlocks &bBlocks, int value) {
+    using namespace IR;
+    auto temp = std::make_unique<Temp>(Type::Int);
+    bBlocks.back()->addInst(Inst(
+            Op::LoadImd,
+            std::make_unique<Temp>(*temp),
+            std::make_unique<ConstVal>(value, Type::Int),
+            nullptr));
+    return temp;
+}
+
+// every element is initialized, in order.
+// elements known at compile time are grouped:
+// long runs of one value -> Fill, long stretches of other constants -> CopyData, the rest -> Store
+void genArrayInit(IR::BasicBlocks &bBlocks, const IR::Var &var, const std::vector<ExpInitVal *> &flatten) {
+    using namespace IR;
+
+    std::vector<std::optional<int>> values;
+    values.reserve(flatten.size());
+    for (auto expInit: flatten) {
+        int value = expInit->exp->evaluate();
+        values.push_back(Exp::getNonConstValueInEvaluate() ? std::nullopt : std::optional(value));
+    }
+
+    for (std::size_t i = 0; i < values.size();) {
+        if (!values[i]) {
+            store(bBlocks, var, flatten[i]->exp->genIR(bBlocks), i);
+            ++i;
+            continue;
+        }
+
+        auto j = runEnd(values, i);
+        if (j - i >= MIN_FILL_RUN) {
+            bBlocks.back()->addInst(Inst(
+                    Op::Fill,
+                    loadImd(bBlocks, *values[i]),
+                    std::make_unique<Var>(var),
+                    std::make_unique<Range>(static_cast<int>(i), static_cast<int>(j - i))));
+            i = j;
+            continue;
+        }
+
+        // constants up to the next non-constant element or long run
+        while (j < values.size() && values[j] && runEnd(values, j) - j < MIN_FILL_RUN) {
+            j = runEnd(values, j);
+        }
+        if (j - i >= MIN_COPY_DATA) {
+            std::vector<int> words;
+            words.reserve(j - i);
+            for (auto k = i; k < j; ++k) {
+                words.push_back(*values[k]);
+            }
+            bBlocks.back()->addInst(Inst(
+                    Op::CopyData,
+                    std::make_unique<ArrayData>(std::move(words)),
+                    std::make_unique<Var>(var),
+                    std::make_unique<Range>(static_cast<int>(i), static_cast<int>(j - i))));
+        } else {
+            for (auto k = i; k < j; ++k) {
+                store(bBlocks, var, loadImd(bBlocks, *values[k]), k);
+            }
+        }
+        i = j;
+    }
+}
+} // namespace
+
 std::unique_ptr<Def> Def::parse(bool cons, Type type) {
     auto n = std::make_unique<Def>();
     n->cons = cons;
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     n->ident = Ident::parse();
 
     if (SymTab::reDefine(n->ident)) {
@@ -24,10 +116,10 @@ std::unique_ptr<Def> Def::parse(bool cons, Type type) {
 
     std::vector<int> dims; // SymTab dims
 
-    while (Lexer::curLexType == LexType::LBRACK) {
+    while (Lexer::curLexType() == LexType::LBRACK) {
         Lexer::next();
 
-        row = Lexer::curRow;
+        row = Lexer::curRow();
         auto exp = Exp::parse(true);
         dims.push_back(exp->evaluate());
         n->dims.push_back(std::move(exp));
@@ -35,12 +127,12 @@ std::unique_ptr<Def> Def::parse(bool cons, Type type) {
         singleLex(LexType::RBRACK, row);
     }
 
-    if (cons || Lexer::curLexType == LexType::ASSIGN) {
+    if (cons || Lexer::curLexType() == LexType::ASSIGN) {
         Lexer::next();
         n->initVal = InitVal::parse(cons);
     }
 
-    if (cons || SymTab::cur->getDepth() == 0) {
+    if (cons || SymTab::cur()->getDepth() == 0) {
         if (n->initVal) {
             SymTab::add(n->ident, Symbol(n->cons, type, dims, n->initVal->evaluate()));
         } else {
@@ -67,7 +159,7 @@ void Def::genIR(IR::BasicBlocks &bBlocks, Type type) const {
 
     auto var = std::make_unique<Var>(
             ident,
-            SymTab::cur->getDepth(),
+            SymTab::cur()->getDepth(),
             cons,
             SymTab::find(ident)->dims,
             type);
@@ -80,7 +172,7 @@ void Def::genIR(IR::BasicBlocks &bBlocks, Type type) const {
             std::move(var),
             std::move(size)));
 
-    SymTab::knownVars.back().emplace(ident, SymTab::cur->getDepth());
+    SymTab::knownVars().back().emplace(ident, SymTab::cur()->getDepth());
 
     if (initVal) {
         if (dims.empty()) {
@@ -95,17 +187,7 @@ void Def::genIR(IR::BasicBlocks &bBlocks, Type type) const {
                     nullptr));
         } else {
             // array init
-            auto array = dynamic_cast<ArrayInitVal *>(initVal.get());
-
-            int index = 0;
-            for (auto &expInit: array->getFlatten()) {
-                auto value = expInit->exp->genIR(bBlocks);
-                bBlocks.back()->addInst(Inst(
-                        Op::Store,
-                        std::move(value),
-                        std::make_unique<Var>(*pVar),
-                        std::make_unique<ConstVal>(index++, Type::Int)));
-            }
+            genArrayInit(bBlocks, *pVar, dynamic_cast<ArrayInitVal *>(initVal.get())->getFlatten());
         }
     }
 }
@@ -5,6 +5,7 @@
 #include "InitVal.h"
 
 #include "AST/expr/Exp.h"
+#include "errorHandler/Error.h"
 #include "frontend/parser/Parser.h"
 
 using namespace Parser;
@@ -12,7 +13,7 @@ using namespace Parser;
 std::unique_ptr<InitVal> InitVal::parse(bool cons) {
     std::unique_ptr<InitVal> n;
 
-    if (Lexer::curLexType == LexType::LBRACE) {
+    if (Lexer::curLexType() == LexType::LBRACE) {
         n = ArrayInitVal::parse(cons);
     } else {
         n = ExpInitVal::parse(cons);
@@ -36,7 +37,12 @@ std::unique_ptr<ExpInitVal> ExpInitVal::parse(bool cons) {
 }
 
 std::vector<int> ExpInitVal::evaluate() {
-    return std::vector{exp->evaluate()};
+    int value = exp->evaluate();
+    // only the initializers of consts and globals are evaluated, a global's must be constant too
+    if (!cons && Exp::getTrapInEvaluate()) {
+        Error::raise("division by zero or overflow in a constant expression");
+    }
+    return std::vector{value};
 }
 
 std::unique_ptr<ArrayInitVal> ArrayInitVal::parse(bool cons) {
@@ -44,10 +50,10 @@ std::unique_ptr<ArrayInitVal> ArrayInitVal::parse(bool cons) {
     n->cons = cons;
     singleLex(LexType::LBRACE);
 
-    if (Lexer::curLexType != LexType::RBRACE) {
+    if (Lexer::curLexType() != LexType::RBRACE) {
         n->array.push_back(InitVal::parse(cons));
 
-        while (Lexer::curLexType == LexType::COMMA) {
+        while (Lexer::curLexType() == LexType::COMMA) {
             Lexer::next();
             n->array.push_back(InitVal::parse(cons));
         }
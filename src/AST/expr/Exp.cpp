@@ -2,16 +2,17 @@
 // Created by Steel_Shadow on 2023/10/11.
 //
 #include "Exp.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
 #include "frontend/parser/Parser.h"
 
 
 using namespace Parser;
 
-std::unique_ptr<Exp> Exp::parse(bool cons) {
+std::unique_ptr<Exp> Exp::parse(bool cons, std::unique_ptr<LVal> first) {
     auto n = std::make_unique<Exp>();
     n->cons = cons;
-    n->addExp = AddExp::parse();
+    n->addExp = AddExp::parse(std::move(first));
 
     if (cons) {
         output(AST::ConstExp);
@@ -21,11 +22,22 @@ std::unique_ptr<Exp> Exp::parse(bool cons) {
     return n;
 }
 
-bool Exp::getNonConstValueInEvaluate = false;
+bool &Exp::getNonConstValueInEvaluate() {
+    return Context::cur().exp.getNonConstValueInEvaluate;
+}
+
+bool &Exp::getTrapInEvaluate() {
+    return Context::cur().exp.trapInEvaluate;
+}
 
 int Exp::evaluate() const {
-    Exp::getNonConstValueInEvaluate = false;
-    return addExp->evaluate();
+    Exp::getNonConstValueInEvaluate() = false;
+    Exp::getTrapInEvaluate() = false;
+    int val = addExp->evaluate();
+    if (cons && Exp::getTrapInEvaluate()) {
+        Error::raise("division by zero or overflow in a constant expression");
+    }
+    return val;
 }
 
 size_t Exp::getRank() const {
@@ -49,6 +61,6 @@ LVal *Exp::getLVal() const {
 }
 
 int BaseUnaryExp::evaluate() {
-    Exp::getNonConstValueInEvaluate = true;
+    Exp::getNonConstValueInEvaluate() = true;
     return 0;
 }
@@ -29,8 +29,6 @@ struct BaseUnaryExp {
 
 // PrimaryExp → '(' Exp ')' | LVal | Number
 struct PrimaryExp : public BaseUnaryExp {
-    static std::unique_ptr<PrimaryExp> parse();
-
     virtual size_t getRank();
 
     virtual std::string getIdent();
@@ -62,11 +60,19 @@ struct LVal : public PrimaryExp {
 // change syntax to
 // UnaryExp → {UnaryOp} ( PrimaryExp | Ident '(' [FuncRParams] ')' )
 // Note: UnaryOp is not a separate class!
+// Parsed in steps by the MultiExp parser (MultiExp.cpp), so '(' Exp ')' needs no recursion.
 struct UnaryExp {
     std::vector<LexType> ops;
     std::unique_ptr<BaseUnaryExp> baseUnaryExp;
 
-    static std::unique_ptr<UnaryExp> parse();
+    // {UnaryOp}
+    static std::unique_ptr<UnaryExp> parseOps();
+
+    // LVal | Number | Ident '(' [FuncRParams] ')'
+    void parseBase();
+
+    // output <PrimaryExp> and <UnaryExp> after the base is parsed
+    void setBase(std::unique_ptr<BaseUnaryExp> base);
 
     int evaluate() const;
 
@@ -101,8 +107,6 @@ struct PareExp : public PrimaryExp {
     // '(' Exp ')'
     std::unique_ptr<Exp> exp;
 
-    static std::unique_ptr<PareExp> parse();
-
     std::unique_ptr<IR::Temp> genIR(IR::BasicBlocks &bBlocks) override;
 
     int evaluate() override;
@@ -181,16 +185,23 @@ struct MultiExp {
     }
 };
 
+// MultiExps are parsed iteratively with an explicit stack (MultiExp.cpp),
+// deeply nested parentheses don't overflow the native stack.
+// evaluate, genIR and the destructors still recurse once per '(' Exp ')' left after flattening, subscript
+// or call argument, so the parser gives an error past MAX_NESTING of them instead of a stack overflow.
+// A debug build evaluates and generates MAX_NESTING levels within a 1 MiB stack.
+constexpr int MAX_NESTING = 500;
+
 // MulExp → UnaryExp | MulExp ('*' | '/' | '%') UnaryExp
 struct MulExp : MultiExp<UnaryExp> {
-    static std::unique_ptr<MulExp> parse();
+    static std::unique_ptr<MulExp> parse(std::unique_ptr<LVal> first = nullptr);
 
     int evaluate() const;
 };
 
 // AddExp → MulExp | AddExp ('+' | '−') MulExp
 struct AddExp : MultiExp<MulExp> {
-    static std::unique_ptr<AddExp> parse();
+    static std::unique_ptr<AddExp> parse(std::unique_ptr<LVal> first = nullptr);
 
     int evaluate() const;
 };
@@ -235,9 +246,13 @@ struct Exp {
 
     std::unique_ptr<AddExp> addExp;
 
-    static std::unique_ptr<Exp> parse(bool cons);
+    // first: the leading LVal, if Stmt::parse has parsed it to look for '='
+    static std::unique_ptr<Exp> parse(bool cons, std::unique_ptr<LVal> first = nullptr);
 
-    static bool getNonConstValueInEvaluate;
+    static bool &getNonConstValueInEvaluate();
+    // a division in evaluate() traps at run time, its value is taken as non-const 0
+    static bool &getTrapInEvaluate();
+    // a ConstExp raises an error if a division traps
     int evaluate() const;
 
     // get the indexRank of LVal
@@ -256,4 +271,14 @@ struct Exp {
     LVal *getLVal() const;
 };
 
+// Exp state of one compilation, owned by Context
+struct ExpState {
+    bool getNonConstValueInEvaluate{};
+    bool trapInEvaluate{};
+    // LVal::getOffset folds constant subscripts into the offset, else every subscript is computed at run time
+    bool foldOffsets{true};
+    // subscripts and call arguments around the Exp being parsed, with the parentheses open outside them
+    int nesting{};
+};
+
 #endif
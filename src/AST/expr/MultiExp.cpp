@@ -2,47 +2,353 @@
 // Created by Steel_Shadow on 2023/10/12.
 //
 #include "Exp.h"
+#include "Context.h"
 #include "frontend/parser/Parser.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <utility>
+
 using namespace Parser;
 
-std::unique_ptr<Cond> Cond::parse() {
-    auto n = std::make_unique<Cond>();
+namespace {
+// MultiExp levels, from the loosest binding to the tightest
+enum class Level {
+    LOr,
+    LAnd,
+    Eq,
+    Rel,
+    Add,
+    Mul,
+};
+
+Level tighter(Level level) {
+    return static_cast<Level>(static_cast<int>(level) + 1);
+}
 
-    n->lorExp = LOrExp::parse();
+Level looser(Level level) {
+    return static_cast<Level>(static_cast<int>(level) - 1);
+}
 
-    output(AST::Cond);
-    return n;
+// Partial MultiExps of one nesting, from top to Mul.
+// The outermost frame is what X::parse() returns, the others are '(' Exp ')'.
+struct Frame {
+    explicit Frame(Level top, std::unique_ptr<UnaryExp> unaryExp = nullptr, int row = 0) :
+        top(top),
+        unaryExp(std::move(unaryExp)),
+        row(row) {}
+
+    Level top;
+
+    // the UnaryExp waiting for this '(' Exp ')', nullptr in the outermost frame
+    std::unique_ptr<UnaryExp> unaryExp;
+    int row;
+    // of the PareExps appended to this frame, nested in each other
+    int depth{};
+
+    std::unique_ptr<LOrExp> lOrExp;
+    std::unique_ptr<LAndExp> lAndExp;
+    std::unique_ptr<EqExp> eqExp;
+    std::unique_ptr<RelExp> relExp;
+    std::unique_ptr<AddExp> addExp;
+    std::unique_ptr<MulExp> mulExp;
+};
+
+bool isOp(Level level, LexType type) {
+    switch (level) {
+        case Level::LOr:
+            return type == LexType::OR;
+        case Level::LAnd:
+            return type == LexType::AND;
+        case Level::Eq:
+            return type == LexType::EQL || type == LexType::NEQ;
+        case Level::Rel:
+            return type == LexType::LSS || type == LexType::GRE || type == LexType::LEQ || type == LexType::GEQ;
+        case Level::Add:
+            return type == LexType::PLUS || type == LexType::MINU;
+        case Level::Mul:
+            return type == LexType::MULT || type == LexType::DIV || type == LexType::MOD;
+    }
+    return false;
 }
 
-void Cond::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Label &falseBranch) const {
-    lorExp->genIR(basicBlocks, trueBranch, falseBranch);
+template<class T, class E>
+void append(T &n, std::unique_ptr<E> e) {
+    if (n.first == nullptr) {
+        n.first = std::move(e);
+    } else {
+        n.elements.push_back(std::move(e));
+    }
 }
 
-std::unique_ptr<MulExp> MulExp::parse() {
-    auto n = std::make_unique<MulExp>();
+// new MultiExps for the levels from level to Mul
+void open(Frame &f, Level level) {
+    switch (level) {
+        case Level::LOr:
+            f.lOrExp = std::make_unique<LOrExp>();
+            [[fallthrough]];
+        case Level::LAnd:
+            f.lAndExp = std::make_unique<LAndExp>();
+            [[fallthrough]];
+        case Level::Eq:
+            f.eqExp = std::make_unique<EqExp>();
+            [[fallthrough]];
+        case Level::Rel:
+            f.relExp = std::make_unique<RelExp>();
+            [[fallthrough]];
+        case Level::Add:
+            f.addExp = std::make_unique<AddExp>();
+            [[fallthrough]];
+        case Level::Mul:
+            f.mulExp = std::make_unique<MulExp>();
+    }
+}
 
-    n->first = UnaryExp::parse();
-    output(AST::MulExp);
+void addOp(Frame &f, Level level, LexType op) {
+    switch (level) {
+        case Level::LOr:
+            f.lOrExp->ops.push_back(op);
+            break;
+        case Level::LAnd:
+            f.lAndExp->ops.push_back(op);
+            break;
+        case Level::Eq:
+            f.eqExp->ops.push_back(op);
+            break;
+        case Level::Rel:
+            f.relExp->ops.push_back(op);
+            break;
+        case Level::Add:
+            f.addExp->ops.push_back(op);
+            break;
+        case Level::Mul:
+            f.mulExp->ops.push_back(op);
+            break;
+    }
+}
+
+// the MultiExp of level is complete, append it to the looser one
+void close(Frame &f, Level level) {
+    switch (level) {
+        case Level::LOr:
+            break;
+        case Level::LAnd:
+            append(*f.lOrExp, std::move(f.lAndExp));
+            output(AST::LOrExp);
+            break;
+        case Level::Eq:
+            append(*f.lAndExp, std::move(f.eqExp));
+            output(AST::LAndExp);
+            break;
+        case Level::Rel:
+            append(*f.eqExp, std::move(f.relExp));
+            output(AST::EqExp);
+            break;
+        case Level::Add:
+            append(*f.relExp, std::move(f.addExp));
+            output(AST::RelExp);
+            break;
+        case Level::Mul:
+            append(*f.addExp, std::move(f.mulExp));
+            output(AST::AddExp);
+            break;
+    }
+}
+
+// n is {UnaryOp} '(' Exp ')'. If the Exp is a single UnaryExp not based on LVal or FuncCall
+// (whose rank and ident matter), merge it into n: the inner ops are applied first, as before.
+// So ((a)) and -(-(-1)) are as deep as (a) and -1 in genIR and evaluate.
+// return whether n is merged
+bool flatten(UnaryExp &n) {
+    auto pareExp = static_cast<PareExp *>(n.baseUnaryExp.get());
+    auto &addExp = pareExp->exp->addExp;
+    if (!addExp->elements.empty() || !addExp->first->elements.empty()) {
+        return false;
+    }
 
-    while (Lexer::curLexType == LexType::MULT || Lexer::curLexType == LexType::DIV || Lexer::curLexType == LexType::MOD) {
-        n->ops.push_back(Lexer::curLexType);
+    auto &inner = addExp->first->first;
+    if (dynamic_cast<LVal *>(inner->baseUnaryExp.get()) || dynamic_cast<FuncCall *>(inner->baseUnaryExp.get())) {
+        return false;
+    }
+
+    n.ops.insert(n.ops.begin(), inner->ops.begin(), inner->ops.end());
+    auto base = std::move(inner->baseUnaryExp);
+    n.baseUnaryExp = std::move(base);
+    return true;
+}
+
+// skip the tokens of an Exp up to the ')' ']' ',' ';' or '}' ending it
+void skipExp() {
+    int open = 0;
+    for (auto type = Lexer::curLexType(); type != LexType::LEX_END; type = Lexer::curLexType()) {
+        if (type == LexType::LPARENT || type == LexType::LBRACK) {
+            ++open;
+        } else if (type == LexType::RPARENT || type == LexType::RBRACK) {
+            if (open == 0) {
+                return;
+            }
+            --open;
+        } else if (open == 0 && (type == LexType::COMMA || type == LexType::SEMICN || type == LexType::RBRACE)) {
+            return;
+        }
         Lexer::next();
-        n->elements.push_back(UnaryExp::parse());
+    }
+}
+
+// stands for an Exp nested deeper than MAX_NESTING, after the error
+std::unique_ptr<UnaryExp> placeholder() {
+    auto n = std::make_unique<UnaryExp>();
+    n->baseUnaryExp = std::make_unique<Number>();
+    return n;
+}
+
+void raiseTooDeep() {
+    Error::raise("expression nested deeper than " + std::to_string(MAX_NESTING));
+}
+
+// Operator-precedence parsing of the MultiExp levels from top to Mul.
+// Every '(' pushes a frame instead of recursing, output order is the same as recursive descent.
+// Past MAX_NESTING, the error is raised once and the too deep part is replaced by placeholder().
+Frame parseMultiExp(Level top, std::unique_ptr<LVal> first) {
+    std::vector<Frame> frames;
+    frames.push_back(Frame{top});
+    open(frames.back(), top);
+
+    auto &nesting = Context::cur().exp.nesting;
+    bool tooDeep = false;
+    std::unique_ptr<UnaryExp> unaryExp;
+    if (first) {
+        // <LVal> has been output by Stmt::parse
+        unaryExp = std::make_unique<UnaryExp>();
+        unaryExp->setBase(std::move(first));
+    } else if (nesting > MAX_NESTING) {
+        // a subscript or call argument, its parser would recurse again
+        raiseTooDeep();
+        skipExp();
+        unaryExp = placeholder();
+    }
+
+    while (true) {
+        // UnaryExp → {UnaryOp} ( '(' Exp ')' | LVal | Number | Ident '(' [FuncRParams] ')' )
+        while (unaryExp == nullptr) {
+            auto n = UnaryExp::parseOps();
+            if (Lexer::curLexType() == LexType::LPARENT) {
+                Lexer::next();
+                frames.push_back(Frame{Level::Add, std::move(n), Lexer::curRow()});
+                open(frames.back(), Level::Add);
+            } else if (Lexer::curLexType() == LexType::IDENFR || Lexer::curLexType() == LexType::INTCON) {
+                // the Exps of subscripts and call arguments are inside the open parentheses
+                auto around = static_cast<int>(frames.size());
+                nesting += around;
+                n->parseBase();
+                nesting -= around;
+                unaryExp = std::move(n);
+            } else {
+                Error::raise();
+            }
+        }
+
+        append(*frames.back().mulExp, std::move(unaryExp));
         output(AST::MulExp);
+
+        // close levels until an operator binds, or the frame ends
+        Level level = Level::Mul;
+        while (true) {
+            Frame &f = frames.back();
+
+            if (isOp(level, Lexer::curLexType())) {
+                addOp(f, level, Lexer::curLexType());
+                Lexer::next();
+                if (level != Level::Mul) {
+                    open(f, tighter(level));
+                }
+                break;
+            }
+
+            if (level != f.top) {
+                close(f, level);
+                level = looser(level);
+                continue;
+            }
+
+            if (frames.size() == 1) {
+                return std::move(f);
+            }
+
+            // '(' Exp ')'
+            auto exp = std::make_unique<Exp>();
+            exp->cons = false;
+            exp->addExp = std::move(f.addExp);
+            output(AST::Exp);
+            singleLex(LexType::RPARENT, f.row);
+
+            auto pareExp = std::make_unique<PareExp>();
+            pareExp->exp = std::move(exp);
+
+            auto n = std::move(f.unaryExp);
+            auto depth = f.depth;
+            frames.pop_back();
+            n->setBase(std::move(pareExp));
+            if (!flatten(*n)) {
+                ++depth;
+            }
+            if (nesting + depth > MAX_NESTING) {
+                if (!tooDeep) {
+                    raiseTooDeep();
+                    tooDeep = true;
+                }
+                n->baseUnaryExp = std::make_unique<Number>();
+                depth = 0;
+            }
+
+            frames.back().depth = std::max(frames.back().depth, depth);
+            append(*frames.back().mulExp, std::move(n));
+            output(AST::MulExp);
+            level = Level::Mul;
+        }
     }
+}
+} // namespace
+
+std::unique_ptr<Cond> Cond::parse() {
+    auto n = std::make_unique<Cond>();
+
+    n->lorExp = LOrExp::parse();
 
+    output(AST::Cond);
     return n;
 }
 
+void Cond::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Label &falseBranch) const {
+    lorExp->genIR(basicBlocks, trueBranch, falseBranch);
+}
+
+std::unique_ptr<MulExp> MulExp::parse(std::unique_ptr<LVal> first) {
+    return parseMultiExp(Level::Mul, std::move(first)).mulExp;
+}
+
 int MulExp::evaluate() const {
     int val = first->evaluate();
     for (int i = 0; i < ops.size(); ++i) {
         auto op = ops[i];
         auto e = elements[i]->evaluate();
         if (op == LexType::MULT) {
-            val *= e;
-        } else if (op == LexType::DIV) {
+            // wrap around on overflow like mul, see foldConstants
+            val = static_cast<int>(static_cast<std::uint32_t>(val) * static_cast<std::uint32_t>(e));
+            continue;
+        }
+        if (e == 0 || (val == INT_MIN && e == -1)) {
+            // traps at run time: an error in a constant expression, see Exp::evaluate, else left to run time
+            // a non-const operand evaluates to 0 too, it's not a trap then
+            if (!Exp::getNonConstValueInEvaluate()) {
+                Exp::getTrapInEvaluate() = true;
+            }
+            Exp::getNonConstValueInEvaluate() = true;
+            return 0;
+        }
+        if (op == LexType::DIV) {
             val /= e;
         } else if (op == LexType::MOD) {
             val %= e;
@@ -51,20 +357,8 @@ int MulExp::evaluate() const {
     return val;
 }
 
-std::unique_ptr<AddExp> AddExp::parse() {
-    auto n = std::make_unique<AddExp>();
-
-    n->first = MulExp::parse();
-    output(AST::AddExp);
-
-    while (Lexer::curLexType == LexType::PLUS || Lexer::curLexType == LexType::MINU) {
-        n->ops.push_back(Lexer::curLexType);
-        Lexer::next();
-        n->elements.push_back(MulExp::parse());
-        output(AST::AddExp);
-    }
-
-    return n;
+std::unique_ptr<AddExp> AddExp::parse(std::unique_ptr<LVal> first) {
+    return parseMultiExp(Level::Add, std::move(first)).addExp;
 }
 
 int AddExp::evaluate() const {
@@ -72,45 +366,22 @@ int AddExp::evaluate() const {
     for (int i = 0; i < ops.size(); ++i) {
         auto op = ops[i];
         auto e = elements[i]->evaluate();
+        // wrap around on overflow like addu and subu, see foldConstants
         if (op == LexType::PLUS) {
-            val += e;
+            val = static_cast<int>(static_cast<std::uint32_t>(val) + static_cast<std::uint32_t>(e));
         } else if (op == LexType::MINU) {
-            val -= e;
+            val = static_cast<int>(static_cast<std::uint32_t>(val) - static_cast<std::uint32_t>(e));
         }
     }
     return val;
 }
 
 std::unique_ptr<RelExp> RelExp::parse() {
-    auto n = std::make_unique<RelExp>();
-
-    n->first = AddExp::parse();
-    output(AST::RelExp);
-
-    while (Lexer::curLexType == LexType::LSS || Lexer::curLexType == LexType::GRE || Lexer::curLexType == LexType::LEQ || Lexer::curLexType == LexType::GEQ) {
-        n->ops.push_back(Lexer::curLexType);
-        Lexer::next();
-        n->elements.push_back(AddExp::parse());
-        output(AST::RelExp);
-    }
-
-    return n;
+    return parseMultiExp(Level::Rel, nullptr).relExp;
 }
 
 std::unique_ptr<EqExp> EqExp::parse() {
-    auto n = std::make_unique<EqExp>();
-
-    n->first = RelExp::parse();
-    output(AST::EqExp);
-
-    while (Lexer::curLexType == LexType::EQL || Lexer::curLexType == LexType::NEQ) {
-        n->ops.push_back(Lexer::curLexType);
-        Lexer::next();
-        n->elements.push_back(RelExp::parse());
-        output(AST::EqExp);
-    }
-
-    return n;
+    return parseMultiExp(Level::Eq, nullptr).eqExp;
 }
 
 void EqExp::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Label &falseBranch) const {
@@ -134,19 +405,7 @@ void EqExp::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Label
 }
 
 std::unique_ptr<LAndExp> LAndExp::parse() {
-    auto n = std::make_unique<LAndExp>();
-
-    n->first = EqExp::parse();
-    output(AST::LAndExp);
-
-    while (Lexer::curLexType == LexType::AND) {
-        n->ops.push_back(Lexer::curLexType);
-        Lexer::next();
-        n->elements.push_back(EqExp::parse());
-        output(AST::LAndExp);
-    }
-
-    return n;
+    return parseMultiExp(Level::LAnd, nullptr).lAndExp;
 }
 
 void LAndExp::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Label &falseBranch) const {
@@ -168,19 +427,7 @@ void LAndExp::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Lab
 }
 
 std::unique_ptr<LOrExp> LOrExp::parse() {
-    auto n = std::make_unique<LOrExp>();
-
-    n->first = LAndExp::parse();
-    output(AST::LOrExp);
-
-    while (Lexer::curLexType == LexType::OR) {
-        n->ops.push_back(Lexer::curLexType);
-        Lexer::next();
-        n->elements.push_back(LAndExp::parse());
-        output(AST::LOrExp);
-    }
-
-    return n;
+    return parseMultiExp(Level::LOr, nullptr).lOrExp;
 }
 
 void LOrExp::genIR(IR::BasicBlocks &basicBlocks, IR::Label &trueBranch, IR::Label &falseBranch) const {
@@ -4,12 +4,14 @@
 #include "AST/decl/Decl.h"
 #include "AST/func/Func.h"
 #include "backend/Register.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
 #include "Exp.h"
 #include "frontend/parser/Parser.h"
 #include "frontend/symTab/SymTab.h"
 
 
+#include <charconv>
 #include <iostream>
 
 using namespace Parser;
@@ -22,9 +24,9 @@ std::unique_ptr<LVal> LVal::parse() {
         Error::raise('c');
     }
 
-    while (Lexer::curLexType == LexType::LBRACK) {
+    while (Lexer::curLexType() == LexType::LBRACK) {
         Lexer::next();
-        int row = Lexer::curRow;
+        int row = Lexer::curRow();
         n->dims.push_back(Exp::parse(false));
         singleLex(LexType::RBRACK, row);
     }
@@ -112,13 +114,13 @@ int LVal::evaluate() {
         Error::raise("LVal not found in evaluate()");
         return 0;
     } else if (!sym->cons) {
-        Exp::getNonConstValueInEvaluate = true;
+        Exp::getNonConstValueInEvaluate() = true;
         // Non-const LVal in evaluate()
         return 0;
     } else if (sym->dims.empty()) {
         return sym->initVal[0];
     } else {
-        Exp::getNonConstValueInEvaluate = true;
+        Exp::getNonConstValueInEvaluate() = true;
         // Const Array element in evaluate()
         return 0;
     }
@@ -138,7 +140,7 @@ bool LVal::getOffset(int &constOffset, std::unique_ptr<IR::Temp> &dynamicOffset,
 
         if (i < dims.size()) {
             constIndex = dims[i]->evaluate();
-            if (Exp::getNonConstValueInEvaluate) {
+            if (Exp::getNonConstValueInEvaluate() || !Context::cur().exp.foldOffsets) {
                 getNonConstIndex = true;
             }
             if (getNonConstIndex) {
@@ -194,19 +196,6 @@ Type LVal::getType() {
     return sym ? sym->type : Type::Void;
 }
 
-std::unique_ptr<PrimaryExp> PrimaryExp::parse() {
-    std::unique_ptr<PrimaryExp> n;
-    if (Lexer::curLexType == LexType::LPARENT) {
-        n = PareExp::parse();
-    } else if (Lexer::curLexType == LexType::IDENFR) {
-        n = LVal::parse();
-    } else if (Lexer::curLexType == LexType::INTCON) {
-        n = Number::parse();
-    }
-    output(AST::PrimaryExp);
-    return n;
-}
-
 size_t PrimaryExp::getRank() {
     if (auto p = dynamic_cast<LVal *>(this)) {
         return p->getRank();
@@ -221,23 +210,18 @@ std::string PrimaryExp::getIdent() {
     return "";
 }
 
-std::unique_ptr<PareExp> PareExp::parse() {
-    auto n = std::make_unique<PareExp>();
-
-    Lexer::next();
-    int row = Lexer::curRow;
-    n->exp = Exp::parse(false);
-    singleLex(LexType::RPARENT, row);
-
-    return n;
-}
-
 std::unique_ptr<IR::Temp> PareExp::genIR(IR::BasicBlocks &bBlocks) {
     return exp->genIR(bBlocks);
 }
 
 int PareExp::evaluate() {
-    return exp->evaluate();
+    // Exp::evaluate() clears the flags, keep what the enclosing Exp has found
+    bool nonConst = Exp::getNonConstValueInEvaluate();
+    bool trap = Exp::getTrapInEvaluate();
+    int val = exp->evaluate();
+    Exp::getNonConstValueInEvaluate() |= nonConst;
+    Exp::getTrapInEvaluate() |= trap;
+    return val;
 }
 
 Type PareExp::getType() {
@@ -247,8 +231,8 @@ Type PareExp::getType() {
 std::unique_ptr<Number> Number::parse() {
     auto n = std::make_unique<Number>();
 
-    if (Lexer::curLexType == LexType::INTCON) {
-        n->intConst = std::stoi(Lexer::curToken);
+    if (Lexer::curLexType() == LexType::INTCON) {
+        std::from_chars(Lexer::curToken().data(), Lexer::curToken().data() + Lexer::curToken().size(), n->intConst);
         Lexer::next();
     } else {
         Error::raise();
@@ -277,57 +261,44 @@ Type Number::getType() {
     return Type::Int;
 }
 
-std::unique_ptr<UnaryExp> UnaryExp::parse() {
+std::unique_ptr<UnaryExp> UnaryExp::parseOps() {
     auto n = std::make_unique<UnaryExp>();
 
-    bool getBaseUnaryExp = false;
-    while (!getBaseUnaryExp) {
-        // UnaryExp → {UnaryOp} ( PrimaryExp | Ident '(' [FuncRParams] ')' )
-        switch (Lexer::curLexType) {
-            case LexType::PLUS:
-            case LexType::MINU:
-            case LexType::NOT:
-                // UnaryOp → '+' | '−' | '!'
-                n->ops.push_back(Lexer::curLexType);
-                Lexer::next();
-
-                output(AST::UnaryOp);
-                break;
-
-            case LexType::LPARENT:
-            case LexType::INTCON:
-                // PrimaryExp → '(' Exp ')' | LVal | Number
-                n->baseUnaryExp = PrimaryExp::parse();
-                getBaseUnaryExp = true;
-
-                output(AST::UnaryExp);
-                break;
-
-            case LexType::IDENFR:
-                // PrimaryExp → '(' Exp ')' | LVal | Number
-                // LVal → Ident {'[' Exp ']'}
-
-                // Ident '(' [FuncRParams] ')'
-                if (Lexer::peek(1).first == LexType::LPARENT) {
-                    n->baseUnaryExp = FuncCall::parse();
-                } else {
-                    n->baseUnaryExp = PrimaryExp::parse();
-                }
-                getBaseUnaryExp = true;
+    // UnaryOp → '+' | '−' | '!'
+    while (Lexer::curLexType() == LexType::PLUS || Lexer::curLexType() == LexType::MINU || Lexer::curLexType() == LexType::NOT) {
+        n->ops.push_back(Lexer::curLexType());
+        Lexer::next();
+
+        output(AST::UnaryOp);
+    }
 
-                output(AST::UnaryExp);
-                break;
+    return n;
+}
 
-            default:
-                Error::raise();
+void UnaryExp::parseBase() {
+    if (Lexer::curLexType() == LexType::IDENFR) {
+        // Ident '(' [FuncRParams] ')'
+        if (Lexer::peek(1).first == LexType::LPARENT) {
+            setBase(FuncCall::parse());
+        } else {
+            // LVal → Ident {'[' Exp ']'}
+            setBase(LVal::parse());
         }
+    } else {
+        setBase(Number::parse());
     }
+}
 
-    for (int i = 0; i < n->ops.size(); i++) {
-        output(AST::UnaryExp);
+void UnaryExp::setBase(std::unique_ptr<BaseUnaryExp> base) {
+    baseUnaryExp = std::move(base);
+    if (dynamic_cast<PrimaryExp *>(baseUnaryExp.get())) {
+        output(AST::PrimaryExp);
     }
 
-    return n;
+    output(AST::UnaryExp);
+    for (int i = 0; i < ops.size(); i++) {
+        output(AST::UnaryExp);
+    }
 }
 
 int UnaryExp::evaluate() const {
@@ -335,7 +306,7 @@ int UnaryExp::evaluate() const {
 
     for (auto op: ops) {
         if (op == LexType::MINU) {
-            val = -val;
+            val = static_cast<int>(0u - static_cast<std::uint32_t>(val));
         }
     }
 
@@ -400,7 +371,7 @@ Type UnaryExp::getType() const {
 std::unique_ptr<FuncCall> FuncCall::parse() {
     auto n = std::make_unique<FuncCall>();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     n->ident = Ident::parse();
 
     Symbol *funcSym = SymTab::find(n->ident);
@@ -410,7 +381,7 @@ std::unique_ptr<FuncCall> FuncCall::parse() {
 
     singleLex(LexType::LPARENT);
 
-    if (Lexer::curLexType != LexType::RPARENT) {
+    if (Lexer::curLexType() != LexType::RPARENT) {
         n->funcRParams = FuncRParams::parse();
     }
 
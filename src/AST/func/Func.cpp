@@ -7,6 +7,7 @@
 #include "errorHandler/Error.h"
 #include "frontend/parser/Parser.h"
 #include "frontend/symTab/SymTab.h"
+#include "tools/Stats.h"
 
 using namespace Parser;
 
@@ -16,7 +17,8 @@ std::unique_ptr<FuncDef> FuncDef::parse() {
 
     n->funcType = FuncType::parse();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
+    n->row = row;
     n->ident = Ident::parse();
     if (SymTab::reDefine(n->ident)) {
         Error::raise('b', row);
@@ -27,23 +29,23 @@ std::unique_ptr<FuncDef> FuncDef::parse() {
     std::vector<Param> params{};
 
     singleLex(LexType::LPARENT);
-    if (Lexer::curLexType != LexType::RPARENT) {
+    if (Lexer::curLexType() != LexType::RPARENT) {
         n->funcFParams = FuncFParams::parse();
         params = n->funcFParams->getParameters();
     }
     singleLex(LexType::RPARENT, row);
 
-    SymTab::add(n->ident, Symbol(n->funcType->getType(), params), SymTab::cur->getPrev());
+    SymTab::add(n->ident, Symbol(n->funcType->getType(), params), SymTab::cur()->getPrev());
 
-    Stmt::retVoid = n->funcType->getType() == Type::Void;
+    Stmt::retVoid() = n->funcType->getType() == Type::Void;
     n->block = Block::parse();
 
-    if (!Stmt::retVoid) {
+    if (!Stmt::retVoid()) {
         if (n->block->getBlockItems().empty()
             || !dynamic_cast<ReturnStmt *>(n->block->getBlockItems().back().get())) {
             // In fact, we should check "return;"
             // But it's not included in our work.
-            Error::raise('g', Block::lastRow);
+            Error::raise('g', Block::lastRow());
         }
     }
 
@@ -54,24 +56,25 @@ std::unique_ptr<FuncDef> FuncDef::parse() {
 
 std::unique_ptr<MainFuncDef> MainFuncDef::parse() {
     auto n = std::make_unique<MainFuncDef>();
+    n->row = Lexer::curRow();
 
     singleLex(LexType::INTTK);
     singleLex(LexType::MAINTK);
 
     SymTab::deepIn();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     singleLex(LexType::LPARENT);
     singleLex(LexType::RPARENT, row);
 
-    Stmt::retVoid = false;
+    Stmt::retVoid() = false;
     n->block = Block::parse();
 
-    if (!Stmt::retVoid) {
+    if (!Stmt::retVoid()) {
         if (n->block->getBlockItems().empty() || !dynamic_cast<ReturnStmt *>(n->block->getBlockItems().back().get())) {
             // In fact, we should check "return;"
             // But it's not included in our work.
-            Error::raise('g', Block::lastRow);
+            Error::raise('g', Block::lastRow());
         }
     }
 
@@ -82,6 +85,8 @@ std::unique_ptr<MainFuncDef> MainFuncDef::parse() {
 
 std::unique_ptr<IR::Function> MainFuncDef::genIR() const {
     using namespace IR;
+    Stats::Timer timer("genIR.function", "main");
+    curRow() = row;
     auto main = std::make_unique<Function>(
             "main", Type::Int, std::vector<Param>());
 
@@ -89,7 +94,7 @@ std::unique_ptr<IR::Function> MainFuncDef::genIR() const {
     bBlocks.emplace_back(std::make_unique<BasicBlock>("main", true));
     SymTab::iterIn();
 
-    Function::idAllocator = 0;
+    Function::idAllocator() = 0;
     block->genIR(bBlocks);
 
     main->moveBasicBlocks(std::move(bBlocks));
@@ -100,8 +105,8 @@ std::unique_ptr<IR::Function> MainFuncDef::genIR() const {
 std::unique_ptr<FuncType> FuncType::parse() {
     auto n = std::make_unique<FuncType>();
 
-    if (Lexer::curLexType == LexType::VOIDTK || Lexer::curLexType == LexType::INTTK) {
-        n->type = Lexer::curLexType;
+    if (Lexer::curLexType() == LexType::VOIDTK || Lexer::curLexType() == LexType::INTTK) {
+        n->type = Lexer::curLexType();
         Lexer::next();
     } else {
         Error::raise();
@@ -120,7 +125,7 @@ std::unique_ptr<FuncFParams> FuncFParams::parse() {
 
     n->funcFParams.push_back(FuncFParam::parse());
 
-    while (Lexer::curLexType == LexType::COMMA) {
+    while (Lexer::curLexType() == LexType::COMMA) {
         Lexer::next();
         n->funcFParams.push_back(FuncFParam::parse());
     }
@@ -144,23 +149,23 @@ std::unique_ptr<FuncFParam> FuncFParam::parse() {
 
     n->type = Btype::parse();
 
-    int row = Lexer::curRow; // error handle
+    int row = Lexer::curRow(); // error handle
     n->ident = Ident::parse();
     if (SymTab::reDefine(n->ident)) {
         Error::raise('b', row);
     }
 
     // ['[' ']' { '[' ConstExp ']' }]
-    if (Lexer::curLexType == LexType::LBRACK) {
-        row = Lexer::curRow;
+    if (Lexer::curLexType() == LexType::LBRACK) {
+        row = Lexer::curRow();
         Lexer::next();
         n->dims.push_back(nullptr); // p[] is not p!
         singleLex(LexType::RBRACK, row);
 
-        while (Lexer::curLexType == LexType::LBRACK) {
+        while (Lexer::curLexType() == LexType::LBRACK) {
             Lexer::next();
 
-            row = Lexer::curRow;
+            row = Lexer::curRow();
             n->dims.push_back(Exp::parse(true));
             singleLex(LexType::RBRACK, row);
         }
@@ -192,7 +197,7 @@ std::unique_ptr<FuncRParams> FuncRParams::parse() {
     auto n = std::make_unique<FuncRParams>();
 
     n->params.push_back(Exp::parse(false));
-    while (Lexer::curLexType == LexType::COMMA) {
+    while (Lexer::curLexType() == LexType::COMMA) {
         Lexer::next();
 
         n->params.push_back(Exp::parse(false));
@@ -204,11 +209,13 @@ std::unique_ptr<FuncRParams> FuncRParams::parse() {
 
 std::unique_ptr<IR::Function> FuncDef::genIR() {
     using namespace IR;
+    Stats::Timer timer("genIR.function", ident);
+    curRow() = row;
     auto params = SymTab::find(ident)->params;
     auto function = std::make_unique<Function>(ident, funcType->getType(), params);
 
     BasicBlocks bBlocks;
-    Function::idAllocator = 0;
+    Function::idAllocator() = 0;
 
     SymTab::iterIn();
 
@@ -47,6 +47,7 @@ struct FuncFParams {
 struct FuncDef {
     std::unique_ptr<FuncType> funcType;
     std::string ident;
+    int row{};
     std::unique_ptr<FuncFParams> funcFParams;
     std::unique_ptr<Block> block;
 
@@ -58,6 +59,7 @@ struct FuncDef {
 // MainFuncDef→'int''main''('')'Block
 struct MainFuncDef {
     std::unique_ptr<Block> block;
+    int row{};
 
     static std::unique_ptr<MainFuncDef> parse();
 
@@ -6,25 +6,28 @@
 
 #include "AST/decl/Decl.h"
 #include "backend/Instruction.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
 #include "frontend/parser/Parser.h"
 #include "frontend/symTab/SymTab.h"
 
 using namespace Parser;
 
-int Block::lastRow;
+int &Block::lastRow() {
+    return Context::cur().stmt.lastRow;
+}
 
 std::unique_ptr<Block> Block::parse() {
     auto n = std::make_unique<Block>();
 
     singleLex(LexType::LBRACE);
 
-    while (Lexer::curLexType != LexType::RBRACE) {
+    while (Lexer::curLexType() != LexType::RBRACE) {
         auto i = BlockItem::parse();
         n->blockItems.push_back(std::move(i));
     }
 
-    lastRow = Lexer::curRow;
+    lastRow() = Lexer::curRow();
     Lexer::next(); // }
 
     output(AST::Block);
@@ -39,7 +42,7 @@ std::unique_ptr<BlockItem> BlockItem::parse() {
     std::unique_ptr<BlockItem> n;
 
     // Maybe error when neither Decl nor Stmt. But it's too complicated.
-    if (Lexer::curLexType == LexType::CONSTTK || Lexer::curLexType == LexType::INTTK) {
+    if (Lexer::curLexType() == LexType::CONSTTK || Lexer::curLexType() == LexType::INTTK) {
         n = Decl::parse();
     } else {
         n = Stmt::parse();
@@ -56,12 +59,15 @@ void Block::genIR(IR::BasicBlocks &basicBlocks) const {
     }
 }
 
-bool Stmt::retVoid;
+bool &Stmt::retVoid() {
+    return Context::cur().stmt.retVoid;
+}
 
 std::unique_ptr<Stmt> Stmt::parse() {
     std::unique_ptr<Stmt> n;
+    int row = Lexer::curRow();
 
-    switch (Lexer::curLexType) {
+    switch (Lexer::curLexType()) {
         case LexType::LBRACE:
             n = BlockStmt::parse();
             break;
@@ -88,11 +94,18 @@ std::unique_ptr<Stmt> Stmt::parse() {
             Lexer::next();
             break;
         case LexType::IDENFR:
-            //find '=' to distinguish LVal and Exp
-            if (Lexer::findAssignBeforeSemicolon()) {
-                n = LValStmt::parse();
-            } else {
+            if (Lexer::peek(1).first == LexType::LPARENT) {
+                // FuncCall
                 n = ExpStmt::parse();
+            } else {
+                // LVal is a prefix of both LValStmt and Exp,
+                // parse it once and look for '=' after it
+                auto lVal = LVal::parse();
+                if (Lexer::curLexType() == LexType::ASSIGN) {
+                    n = LValStmt::parse(std::move(lVal), row);
+                } else {
+                    n = ExpStmt::parse(std::move(lVal), row);
+                }
             }
             break;
         default:
@@ -100,6 +113,7 @@ std::unique_ptr<Stmt> Stmt::parse() {
             break;
     }
 
+    n->row = row;
     output(AST::Stmt);
     return n;
 }
@@ -112,12 +126,12 @@ std::unique_ptr<IfStmt> IfStmt::parse() {
     SymTab::deepIn();
     singleLex(LexType::LPARENT);
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     n->cond = Cond::parse();
     singleLex(LexType::RPARENT, row);
     n->ifStmt = Stmt::parse();
 
-    if (Lexer::curLexType == LexType::ELSETK) {
+    if (Lexer::curLexType() == LexType::ELSETK) {
         Lexer::next();
         n->elseStmt = Stmt::parse();
     }
@@ -127,6 +141,7 @@ std::unique_ptr<IfStmt> IfStmt::parse() {
 }
 
 void IfStmt::genIR(IR::BasicBlocks &bBlocks) {
+    IR::curRow() = row;
     SymTab::iterIn();
     bBlocks.back()->addInst(IR::Inst(
             IR::Op::InStack, nullptr, nullptr, nullptr));
@@ -153,45 +168,53 @@ void IfStmt::genIR(IR::BasicBlocks &bBlocks) {
     SymTab::iterOut();
 }
 
-int BigForStmt::inForDepth = 0;
+int &BigForStmt::inForDepth() {
+    return Context::cur().stmt.inForDepth;
+}
 
 std::unique_ptr<BigForStmt> BigForStmt::parse() {
     auto n = std::make_unique<BigForStmt>();
 
-    inForDepth++;
+    inForDepth()++;
 
     Lexer::next();
     singleLex(LexType::LPARENT);
 
     SymTab::deepIn();
 
-    if (Lexer::curLexType != LexType::SEMICN) {
+    if (Lexer::curLexType() != LexType::SEMICN) {
         n->init = ForStmt::parse();
     }
     singleLex(LexType::SEMICN);
 
-    if (Lexer::curLexType != LexType::SEMICN) {
+    if (Lexer::curLexType() != LexType::SEMICN) {
         n->cond = Cond::parse();
     }
     singleLex(LexType::SEMICN);
 
-    if (Lexer::curLexType != LexType::RPARENT) {
+    if (Lexer::curLexType() != LexType::RPARENT) {
         n->iter = ForStmt::parse();
     }
     singleLex(LexType::RPARENT);
 
     n->stmt = Stmt::parse();
 
-    inForDepth--;
+    inForDepth()--;
     SymTab::deepOut(); // ForStmt
     return n;
 }
 
-std::stack<IR::Label> BigForStmt::stackEndLabel{};
-std::stack<IR::Label> BigForStmt::stackIterLabel{};
+std::stack<IR::Label> &BigForStmt::stackEndLabel() {
+    return Context::cur().stmt.stackEndLabel;
+}
+
+std::stack<IR::Label> &BigForStmt::stackIterLabel() {
+    return Context::cur().stmt.stackIterLabel;
+}
 
 void BigForStmt::genIR(IR::BasicBlocks &bBlocks) {
     using namespace IR;
+    curRow() = row;
 
     SymTab::iterIn();
     bBlocks.back()->addInst(IR::Inst(
@@ -204,8 +227,8 @@ void BigForStmt::genIR(IR::BasicBlocks &bBlocks) {
     auto forIterCondBlock = std::make_unique<BasicBlock>("ForIter");
     auto forEndBlock = std::make_unique<BasicBlock>("ForEnd");
 
-    stackEndLabel.push(forEndBlock->label);
-    stackIterLabel.push(forIterCondBlock->label);
+    stackEndLabel().push(forEndBlock->label);
+    stackIterLabel().push(forIterCondBlock->label);
 
     // use unique_ptr after move
     auto pForBodyBlock = forBodyBlock.get();
@@ -221,6 +244,7 @@ void BigForStmt::genIR(IR::BasicBlocks &bBlocks) {
     }
 
     bBlocks.push_back(std::move(forIterCondBlock));
+    curRow() = row; // stmt may have moved it
     if (iter) {
         iter->genIR(bBlocks);
     }
@@ -232,8 +256,8 @@ void BigForStmt::genIR(IR::BasicBlocks &bBlocks) {
 
     bBlocks.push_back(std::move(forEndBlock));
 
-    stackEndLabel.pop();
-    stackIterLabel.pop();
+    stackEndLabel().pop();
+    stackIterLabel().pop();
 
     SymTab::iterOut();
     bBlocks.back()->addInst(IR::Inst(
@@ -268,9 +292,9 @@ void ForStmt::genIR(IR::BasicBlocks &basicBlocks) const {
 }
 
 std::unique_ptr<BreakStmt> BreakStmt::parse() {
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
 
-    if (BigForStmt::inForDepth == 0) {
+    if (BigForStmt::inForDepth() == 0) {
         Error::raise('m', row);
     }
 
@@ -283,14 +307,14 @@ void BreakStmt::genIR(IR::BasicBlocks &bBlocks) {
     using namespace IR;
     bBlocks.back()->addInst(Inst(IR::Op::Br,
                                  nullptr,
-                                 std::make_unique<Label>(BigForStmt::stackEndLabel.top()),
+                                 std::make_unique<Label>(BigForStmt::stackEndLabel().top()),
                                  nullptr));
 }
 
 std::unique_ptr<ContinueStmt> ContinueStmt::parse() {
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
 
-    if (BigForStmt::inForDepth == 0) {
+    if (BigForStmt::inForDepth() == 0) {
         Error::raise('m', row);
     }
 
@@ -303,7 +327,7 @@ void ContinueStmt::genIR(IR::BasicBlocks &bBlocks) {
     using namespace IR;
     bBlocks.back()->addInst(Inst(IR::Op::Br,
                                  nullptr,
-                                 std::make_unique<Label>(BigForStmt::stackIterLabel.top()),
+                                 std::make_unique<Label>(BigForStmt::stackIterLabel().top()),
                                  nullptr));
 }
 
@@ -312,13 +336,13 @@ std::unique_ptr<ReturnStmt> ReturnStmt::parse() {
 
     Lexer::next();
 
-    if (Lexer::curLexType == LexType::SEMICN) {
+    if (Lexer::curLexType() == LexType::SEMICN) {
         Lexer::next();
     } else {
-        if (Stmt::retVoid) {
+        if (Stmt::retVoid()) {
             Error::raise('f');
         }
-        int row = Lexer::curRow; // error handle
+        int row = Lexer::curRow(); // error handle
         n->exp = Exp::parse(false);
         singleLex(LexType::SEMICN, row);
     }
@@ -326,25 +350,27 @@ std::unique_ptr<ReturnStmt> ReturnStmt::parse() {
     return n;
 }
 
-bool ReturnStmt::inMainGen;
+bool &ReturnStmt::inMainGen() {
+    return Context::cur().stmt.inMainGen;
+}
 
 void ReturnStmt::genIR(IR::BasicBlocks &bBlocks) {
     using namespace IR;
     if (exp) {
         auto temp = exp->genIR(bBlocks);
-        bBlocks.back()->addInst(Inst(inMainGen ? Op::RetMain : Op::Ret,
+        bBlocks.back()->addInst(Inst(inMainGen() ? Op::RetMain : Op::Ret,
                                      nullptr,
                                      std::move(temp),
                                      nullptr));
     } else {
-        bBlocks.back()->addInst(Inst(inMainGen ? Op::RetMain : Op::Ret,
+        bBlocks.back()->addInst(Inst(inMainGen() ? Op::RetMain : Op::Ret,
                                      nullptr,
                                      nullptr,
                                      nullptr));
     }
 }
 
-void PrintStmt::checkFormatString(const std::string &str) {
+void PrintStmt::checkFormatString(std::string_view str) {
     // skip begin and end " "
     for (int i = 1; i < str.length() - 1; i++) {
         char c = str[i];
@@ -368,21 +394,21 @@ void PrintStmt::checkFormatString(const std::string &str) {
 std::unique_ptr<PrintStmt> PrintStmt::parse() {
     auto n = std::make_unique<PrintStmt>();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     Lexer::next();
 
     singleLex(LexType::LPARENT);
 
-    if (Lexer::curLexType == LexType::STRCON) {
-        n->checkFormatString(Lexer::curToken);
-        n->formatString = Lexer::curToken;
+    if (Lexer::curLexType() == LexType::STRCON) {
+        n->checkFormatString(Lexer::curToken());
+        n->formatString = Lexer::curToken();
         Lexer::next();
     } else {
         Error::raise();
     }
 
     int numOfExp = 0;
-    while (Lexer::curLexType == LexType::COMMA) {
+    while (Lexer::curLexType() == LexType::COMMA) {
         Lexer::next();
         numOfExp++;
         n->exps.push_back(Exp::parse(false));
@@ -402,7 +428,7 @@ void PrintStmt::addStr(const IR::BasicBlocks &bBlocks, std::string &buffer) {
         return;
     }
 
-    IR::Str::MIPS_strings.push_back('\"' + buffer + '\"');
+    IR::Str::MIPS_strings().push_back('\"' + buffer + '\"');
     buffer.clear();
     bBlocks.back()->addInst(IR::Inst(IR::Op::PrintStr,
                                      nullptr,
@@ -437,12 +463,9 @@ void PrintStmt::genIR(IR::BasicBlocks &bBlocks) {
     addStr(bBlocks, buffer);
 }
 
-std::unique_ptr<LValStmt> LValStmt::parse() {
+std::unique_ptr<LValStmt> LValStmt::parse(std::unique_ptr<LVal> lVal, int row) {
     std::unique_ptr<LValStmt> n;
 
-    int row = Lexer::curRow;
-    auto lVal = LVal::parse();
-
     auto sym = SymTab::find(lVal->getIdent());
     if (sym && sym->cons) {
         Error::raise('h', row);
@@ -450,7 +473,7 @@ std::unique_ptr<LValStmt> LValStmt::parse() {
 
     singleLex(LexType::ASSIGN);
 
-    if (Lexer::curLexType == LexType::GETINTTK) {
+    if (Lexer::curLexType() == LexType::GETINTTK) {
         n = GetIntStmt::parse();
         n->lVal = std::move(lVal);
     } else {
@@ -464,7 +487,7 @@ std::unique_ptr<LValStmt> LValStmt::parse() {
 std::unique_ptr<GetIntStmt> GetIntStmt::parse() {
     auto n = std::make_unique<GetIntStmt>();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
 
     singleLex(LexType::GETINTTK);
     singleLex(LexType::LPARENT);
@@ -518,7 +541,7 @@ void GetIntStmt::genIR(IR::BasicBlocks &bBlocks) {
 std::unique_ptr<AssignStmt> AssignStmt::parse() {
     auto n = std::make_unique<AssignStmt>();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     n->exp = Exp::parse(false);
     singleLex(LexType::SEMICN, row);
 
@@ -564,13 +587,22 @@ void AssignStmt::genIR(IR::BasicBlocks &bBlocks) {
 std::unique_ptr<ExpStmt> ExpStmt::parse() {
     auto n = std::make_unique<ExpStmt>();
 
-    int row = Lexer::curRow;
+    int row = Lexer::curRow();
     n->exp = Exp::parse(false);
     singleLex(LexType::SEMICN, row);
 
     return n;
 }
 
+std::unique_ptr<ExpStmt> ExpStmt::parse(std::unique_ptr<LVal> first, int row) {
+    auto n = std::make_unique<ExpStmt>();
+
+    n->exp = Exp::parse(false, std::move(first));
+    singleLex(LexType::SEMICN, row);
+
+    return n;
+}
+
 void ExpStmt::genIR(IR::BasicBlocks &bBlocks) {
     using namespace IR;
     if (exp) {
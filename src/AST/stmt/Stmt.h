@@ -8,6 +8,7 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -38,9 +39,11 @@ struct BlockItem {
 // | LVal '=' 'getint''('')'';'
 // | 'printf''('FormatString{','Exp}')'';'
 struct Stmt : public BlockItem {
+    int row{}; // where the Stmt starts
+
     static std::unique_ptr<Stmt> parse();
 
-    static bool retVoid; // check return in FuncDef
+    static bool &retVoid(); // check return in FuncDef
 };
 
 /*-----------------------------------------------------------*/
@@ -49,7 +52,8 @@ struct Stmt : public BlockItem {
 struct LValStmt : public Stmt {
     std::unique_ptr<LVal> lVal;
 
-    static std::unique_ptr<LValStmt> parse();
+    // lVal is parsed by Stmt::parse, row is where the Stmt starts
+    static std::unique_ptr<LValStmt> parse(std::unique_ptr<LVal> lVal, int row);
 };
 
 // LVal '=' Exp ';'
@@ -67,6 +71,9 @@ struct ExpStmt : public Stmt {
 
     static std::unique_ptr<ExpStmt> parse();
 
+    // Exp starts with an LVal already parsed by Stmt::parse
+    static std::unique_ptr<ExpStmt> parse(std::unique_ptr<LVal> first, int row);
+
     void genIR(IR::BasicBlocks &bBlocks) override;
 };
 
@@ -78,7 +85,7 @@ struct Block {
 
     static std::unique_ptr<Block> parse();
 
-    static int lastRow; // show return error message
+    static int &lastRow(); // show return error message
 
     void genIR(IR::BasicBlocks &basicBlocks) const;
 };
@@ -135,12 +142,12 @@ struct BigForStmt : public Stmt {
     std::unique_ptr<Stmt> stmt;
 
     // for error handling
-    static int inForDepth;
+    static int &inForDepth();
 
     // stack of nested BigForStmt
     // used for break & continue
-    static std::stack<IR::Label> stackEndLabel;
-    static std::stack<IR::Label> stackIterLabel;
+    static std::stack<IR::Label> &stackEndLabel();
+    static std::stack<IR::Label> &stackIterLabel();
 
     static std::unique_ptr<BigForStmt> parse();
 
@@ -151,7 +158,7 @@ struct BigForStmt : public Stmt {
 struct ReturnStmt : public Stmt {
     std::unique_ptr<Exp> exp;
 
-    static bool inMainGen;
+    static bool &inMainGen();
 
     static std::unique_ptr<ReturnStmt> parse();
 
@@ -177,9 +184,19 @@ struct PrintStmt : public Stmt {
     void genIR(IR::BasicBlocks &bBlocks) override;
 
 private:
-    void checkFormatString(const std::string &str);
+    void checkFormatString(std::string_view str);
 
     static void addStr(const IR::BasicBlocks &bBlocks, std::string &buffer);
 };
 
+// Stmt state of one compilation, owned by Context
+struct StmtState {
+    bool retVoid{};
+    int lastRow{};
+    int inForDepth{};
+    std::stack<IR::Label> stackEndLabel;
+    std::stack<IR::Label> stackIterLabel;
+    bool inMainGen{};
+};
+
 #endif
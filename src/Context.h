@@ -0,0 +1,86 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_CONTEXT_H
+#define COMPILER_CONTEXT_H
+
+#include "AST/expr/Exp.h"
+#include "AST/stmt/Stmt.h"
+#include "backend/MIPS.h"
+#include "config.h"
+#include "errorHandler/Error.h"
+#include "frontend/lexer/Lexer.h"
+#include "frontend/symTab/SymTab.h"
+#include "middle/IR.h"
+#include "tools/Stats.h"
+#include "tools/ThreadPool.h"
+
+// All the state of one compilation.
+// Each module keeps its state in a State struct here instead of globals,
+// and reaches it through Context::cur(), the Context bound to the calling thread.
+// compile() owns a Context, so one process can compile many sources,
+// one after another or concurrently on different threads.
+struct Context {
+    Lexer::State lexer;
+    Error::State error;
+    SymTab::State symTab;
+    ExpState exp;
+    StmtState stmt;
+    IR::State ir;
+    MIPS::State mips;
+    Stats::State stats;
+
+    // artifacts to write, set by compile() before Lexer::init
+    Output::Config output;
+
+    // threads this compilation may use, nullptr runs everything on the calling thread
+    ThreadPool *pool{};
+
+    Context() = default;
+    Context(const Context &) = delete;
+    Context &operator=(const Context &) = delete;
+
+    static Context &cur() {
+        return *current;
+    }
+
+    // run fn(0) ... fn(n - 1) on pool, or in order if there is no pool
+    // every call sees this Context as Context::cur()
+    void parallelFor(std::size_t n, const std::function<void(std::size_t)> &fn) {
+        auto task = [&](std::size_t i) {
+            Scope scope(*this);
+            fn(i);
+        };
+        if (pool) {
+            pool->parallelFor(n, task);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                task(i);
+            }
+        }
+    }
+
+    // bind a Context to the calling thread during the lifetime of Scope
+    class Scope {
+        Context *prev;
+
+    public:
+        explicit Scope(Context &context) :
+            prev(current) {
+            current = &context;
+        }
+
+        ~Scope() {
+            current = prev;
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+private:
+    static inline thread_local Context *current = nullptr;
+};
+
+#endif
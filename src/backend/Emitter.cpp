@@ -0,0 +1,44 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Emitter.h"
+
+#include <charconv>
+
+using namespace MIPS;
+
+Emitter::Emitter(std::size_t flushSize) :
+    flushSize(flushSize) {
+    // lines are short, so the buffer is allocated once in practice
+    buffer.reserve(flushSize + 4096);
+}
+
+Emitter::~Emitter() {
+    flush();
+}
+
+void Emitter::addSink(std::ostream &sink) {
+    sinks.push_back(&sink);
+}
+
+Emitter &Emitter::operator<<(int value) {
+    char digits[16];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end - digits);
+    return *this;
+}
+
+void Emitter::flush() {
+    if (buffer.empty()) {
+        return;
+    }
+    for (auto sink: sinks) {
+        sink->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    buffer.clear();
+}
+
+void Emitter::discard() {
+    buffer.clear();
+}
@@ -0,0 +1,63 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_EMITTER_H
+#define COMPILER_EMITTER_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MIPS {
+// formats assembly text into one reusable buffer,
+// and writes it to every sink in large blocks
+class Emitter {
+public:
+    // the buffer is written out once it grows past flushSize
+    explicit Emitter(std::size_t flushSize = 1 << 20);
+
+    ~Emitter();
+
+    Emitter(const Emitter &) = delete;
+    Emitter &operator=(const Emitter &) = delete;
+
+    // sink must outlive the Emitter
+    void addSink(std::ostream &sink);
+
+    Emitter &operator<<(std::string_view str) {
+        buffer.append(str);
+        return *this;
+    }
+
+    Emitter &operator<<(char c) {
+        buffer.push_back(c);
+        return *this;
+    }
+
+    // decimal, no allocation
+    Emitter &operator<<(int value);
+
+    // end of one line, flushes if the buffer is full
+    void endLine() {
+        buffer.push_back('\n');
+        if (buffer.size() >= flushSize) {
+            flush();
+        }
+    }
+
+    void flush();
+
+    // drop the text not written yet
+    void discard();
+
+private:
+    std::size_t flushSize;
+    std::string buffer;
+    std::vector<std::ostream *> sinks;
+};
+} // namespace MIPS
+
+#endif
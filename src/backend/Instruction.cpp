@@ -4,6 +4,7 @@
 
 #include "Instruction.h"
 
+#include <iterator>
 #include <string>
 #include <utility>
 
@@ -17,80 +18,18 @@
 
 using namespace MIPS;
 
-std::string MIPS::opToString(Op e) {
-    switch (e) {
-        case Op::none:
-            return "none";
-        case Op::addu:
-            return "addu";
-        case Op::subu:
-            return "subu";
-        case Op::mul:
-            return "mul";
-        case Op::div:
-            return "div";
-        case Op::mfhi:
-            return "mfhi";
-        case Op::and_:
-            return "and";
-        case Op::or_:
-            return "or";
-        case Op::sw:
-            return "sw";
-        case Op::lw:
-            return "lw";
-        case Op::li:
-            return "li";
-        case Op::syscall:
-            return "syscall";
-        case Op::move:
-            return "move";
-        case Op::la:
-            return "la";
-        case Op::j:
-            return "j";
-        case Op::jal:
-            return "jal";
-        case Op::addi:
-            return "addi";
-        case Op::jr:
-            return "jr";
-        case Op::slt:
-            return "slt";
-        case Op::sle:
-            return "sle";
-        case Op::sge:
-            return "sge";
-        case Op::sgt:
-            return "sgt";
-        case Op::seq:
-            return "seq";
-        case Op::sne:
-            return "sne";
-        case Op::bgtz:
-            return "bgtz";
-        case Op::beqz:
-            return "beqz";
-        case Op::add:
-            return "add";
-        case Op::sll:
-            return "sll";
-        case Op::bne:
-            return "bne";
-        case Op::addiu:
-            return "addiu";
-        case Op::subiu:
-            return "subiu";
-        case Op::andi:
-            return "andi";
-        case Op::ori:
-            return "ori";
-        case Op::slti:
-            return "slti";
-        default:
-            Error::raise("unknown Op");
-            return "unknown";
-    }
+std::string_view MIPS::opName(Op e) {
+    // in the order of Op
+    static constexpr std::string_view names[] = {
+            "none",
+            "addu", "subu", "mul", "div", "mfhi", "and", "or", "addi",
+            "add",
+            "slt", "sle", "sge", "sgt", "seq", "sne",
+            "move", "sw", "lw", "li", "la", "syscall", "j", "jal", "jr", "bgtz", "beqz", "sll", "bne",
+            "addiu", "subiu", "andi", "ori", "slti",
+    };
+    static_assert(std::size(names) == static_cast<std::size_t>(Op::slti) + 1);
+    return names[static_cast<std::size_t>(e)];
 }
 
 Instruction::Instruction(Op op) :
@@ -102,11 +41,11 @@ R_Inst::R_Inst(Op op, Register rd, Register rs, Register rt) :
     rs(rs),
     rt(rt) {}
 
-std::string R_Inst::toString() {
-    return opToString(op) + '\t'
-           + regToString(rd) + '\t'
-           + regToString(rs) + '\t'
-           + regToString(rt);
+void R_Inst::emit(Emitter &out) const {
+    out << opName(op) << '\t'
+        << regName(rd) << '\t'
+        << regName(rs) << '\t'
+        << regName(rt);
 }
 
 I_imm_Inst::I_imm_Inst(Op op, Register rt, Register rs, int immediate) :
@@ -115,17 +54,17 @@ I_imm_Inst::I_imm_Inst(Op op, Register rt, Register rs, int immediate) :
     rs(rs),
     immediate(immediate) {}
 
-std::string I_imm_Inst::toString() {
+void I_imm_Inst::emit(Emitter &out) const {
     if (op == Op::lw || op == Op::sw) {
-        return opToString(op) + '\t'
-               + regToString(rt) + '\t'
-               + std::to_string(immediate)
-               + "(" + regToString(rs) + ")";
+        out << opName(op) << '\t'
+            << regName(rt) << '\t'
+            << immediate
+            << '(' << regName(rs) << ')';
     } else {
-        return opToString(op) + '\t'
-               + regToString(rt) + '\t'
-               + regToString(rs) + '\t'
-               + std::to_string(immediate);
+        out << opName(op) << '\t'
+            << regName(rt) << '\t'
+            << regName(rs) << '\t'
+            << immediate;
     }
 }
 
@@ -136,24 +75,21 @@ I_label_Inst::I_label_Inst(Op op, Register rs, Register rt, Label label, int off
     label(std::move(label)),
     offset(offset) {}
 
-std::string I_label_Inst::toString() {
-    if (rt == Register::none) {
-        return opToString(op) + '\t'
-               + regToString(rs) + '\t'
-               + label.nameAndId
-               + (offset == 0 ? "" : " + " + std::to_string(offset));
-    } else {
-        if (op == Op::bne)
-            return opToString(op) + '\t'
-                   + regToString(rs) + '\t'
-                   + regToString(rt) + '\t'
-                   + label.nameAndId;
-
-        return opToString(op) + '\t'
-               + regToString(rs) + '\t'
-               + label.nameAndId
-               + (offset == 0 ? "" : " + " + std::to_string(offset))
-               + "(" + regToString(rt) + ")";
+void I_label_Inst::emit(Emitter &out) const {
+    out << opName(op) << '\t'
+        << regName(rs) << '\t';
+    if (op == Op::bne && rt != Register::none) {
+        out << regName(rt) << '\t'
+            << label.nameAndId;
+        return;
+    }
+
+    out << label.nameAndId;
+    if (offset != 0) {
+        out << " + " << offset;
+    }
+    if (rt != Register::none) {
+        out << '(' << regName(rt) << ')';
     }
 }
 
@@ -161,32 +97,32 @@ J_Inst::J_Inst(Op op, Label label) :
     Instruction(op),
     label(std::move(label)) {}
 
-std::string J_Inst::toString() {
-    return opToString(op) + '\t'
-           + label.nameAndId;
+void J_Inst::emit(Emitter &out) const {
+    out << opName(op) << '\t'
+        << label.nameAndId;
 }
 
 void MIPS::InStack(const IR::Inst &) {
-    StackMemory::offsetStack.push(StackMemory::curOffset);
-    curDepth++;
+    StackMemory::offsetStack().push(StackMemory::curOffset());
+    curDepth()++;
 }
 
 
 void MIPS::OutStack(const IR::Inst &) {
-    StackMemory::curOffset = StackMemory::offsetStack.top();
-    StackMemory::offsetStack.pop();
+    StackMemory::curOffset() = StackMemory::offsetStack().top();
+    StackMemory::offsetStack().pop();
 
-    for (auto varReg = varToRegs.begin(); varReg != varToRegs.end();) {
+    for (auto varReg = varToRegs().begin(); varReg != varToRegs().end();) {
         auto &[var, reg] = *varReg;
-        if (var.depth == curDepth) {
-            freeVarRegs.push(reg);
-            varReg = varToRegs.erase(varReg);
+        if (var.depth == curDepth()) {
+            freeVarRegs().push(reg);
+            varReg = varToRegs().erase(varReg);
         } else {
             ++varReg;
         }
     }
 
-    curDepth--;
+    curDepth()--;
 }
 
 void MIPS::Store(const IR::Inst &inst) {
@@ -200,20 +136,20 @@ void MIPS::Store(const IR::Inst &inst) {
         arrayOffset = sizeOfType(var->type) * arg2->value;
     }
 
-    auto varReg = varToRegs.find(*var);
-    if (varReg == varToRegs.end()) {
+    auto varReg = varToRegs().find(*var);
+    if (varReg == varToRegs().end()) {
         if (var->depth == 0) {
-            assemblies.push_back(std::make_unique<I_label_Inst>(Op::sw, getReg(value), Register::none, Label(var->name), arrayOffset));
+            assemblies().push_back(std::make_unique<I_label_Inst>(Op::sw, getReg(value), Register::none, Label(var->name), arrayOffset));
         } else {
             if (var->symType == SymType::Param && !var->dims.empty()) {
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(var)));
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::fp, arrayOffset));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(var)));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::fp, arrayOffset));
             } else {
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::sp, -getStackOffset(var) + arrayOffset));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::sp, -getStackOffset(var) + arrayOffset));
             }
         }
     } else {
-        assemblies.push_back(std::make_unique<R_Inst>(Op::move, varReg->second, getReg(value), Register::none));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::move, varReg->second, getReg(value), Register::none));
     }
 }
 
@@ -223,16 +159,105 @@ void MIPS::StoreDynamic(const IR::Inst &inst) {
     auto offset = dynamic_cast<IR::Temp *>(inst.arg2.get());
 
     if (var->depth == 0) {
-        assemblies.push_back(std::make_unique<I_label_Inst>(Op::sw, getReg(value), getReg(offset), Label(var->name)));
+        assemblies().push_back(std::make_unique<I_label_Inst>(Op::sw, getReg(value), getReg(offset), Label(var->name)));
     } else {
         if (var->symType == SymType::Param && !var->dims.empty()) {
-            assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(var)));
-            assemblies.push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::fp, getReg(offset)));
-            assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::fp, 0));
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(var)));
+            assemblies().push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::fp, getReg(offset)));
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::fp, 0));
         } else {
-            assemblies.push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::sp, getReg(offset)));
-            assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::fp, -getStackOffset(var)));
+            assemblies().push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::sp, getReg(offset)));
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(value), Register::fp, -getStackOffset(var)));
+        }
+    }
+}
+
+namespace {
+// words stored per loop iteration of Fill and CopyData
+constexpr int UNROLL = 4;
+// shorter Fills are unrolled completely
+constexpr int MIN_FILL_LOOP = 16;
+
+Label newLoopLabel(const std::string &kind) {
+    return Label(funcState().name + "_" + kind + "_" + std::to_string(funcState().loopIdAllocator++));
+}
+} // namespace
+
+void MIPS::Fill(const IR::Inst &inst) {
+    // li    $t0 v          (Temp)
+    // move  $v1 $t0        a temp is read only once (deadAfter), the loop reads $v1
+    // addiu $t8 $sp begin
+    // addiu $t9 $sp end    (last multiple of UNROLL)
+    // loop:
+    // sw    $v1 0($t8) ... sw $v1 12($t8)
+    // addiu $t8 $t8 16
+    // bne   $t8 $t9 loop
+    // sw    $v1 ...        (the rest)
+    auto value = dynamic_cast<IR::Temp *>(inst.res.get());
+    auto var = dynamic_cast<IR::Var *>(inst.arg1.get());
+    auto range = dynamic_cast<IR::Range *>(inst.arg2.get());
+
+    Register reg = getReg(value);
+    int begin = -getStackOffset(var) + wordSize * range->begin;
+    int looped = 0;
+
+    if (range->count >= MIN_FILL_LOOP) {
+        looped = range->count - range->count % UNROLL;
+        auto loop = newLoopLabel("fill");
+        assemblies().push_back(std::make_unique<R_Inst>(Op::move, Register::v1, reg, Register::none));
+        reg = Register::v1;
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::t8, Register::sp, begin));
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::t9, Register::sp, begin + wordSize * looped));
+        assemblies().push_back(std::make_unique<Label>(loop));
+        for (int i = 0; i < UNROLL; ++i) {
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, reg, Register::t8, wordSize * i));
+        }
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::t8, Register::t8, wordSize * UNROLL));
+        assemblies().push_back(std::make_unique<I_label_Inst>(Op::bne, Register::t8, Register::t9, loop));
+    }
+
+    for (int i = looped; i < range->count; ++i) {
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, reg, Register::sp, begin + wordSize * i));
+    }
+}
+
+void MIPS::CopyData(const IR::Inst &inst) {
+    // la    $t8 arr_0
+    // addiu $t9 $sp begin
+    // addiu $a1 $sp end    (last multiple of UNROLL)
+    // loop:
+    // lw    $v1 0($t8)
+    // sw    $v1 0($t9) ... lw $v1 12($t8)  sw $v1 12($t9)
+    // addiu $t8 $t8 16
+    // addiu $t9 $t9 16
+    // bne   $t9 $a1 loop
+    // lw    $v1 0($t8)
+    // sw    $v1 0($t9) ... (the rest)
+    auto data = dynamic_cast<IR::ArrayData *>(inst.res.get());
+    auto var = dynamic_cast<IR::Var *>(inst.arg1.get());
+    auto range = dynamic_cast<IR::Range *>(inst.arg2.get());
+
+    int begin = -getStackOffset(var) + wordSize * range->begin;
+    int looped = range->count - range->count % UNROLL;
+
+    assemblies().push_back(std::make_unique<I_label_Inst>(Op::la, Register::t8, Register::none, Label(data->toString())));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::t9, Register::sp, begin));
+    if (looped > 0) {
+        auto loop = newLoopLabel("copy");
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::a1, Register::sp, begin + wordSize * looped));
+        assemblies().push_back(std::make_unique<Label>(loop));
+        for (int i = 0; i < UNROLL; ++i) {
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::v1, Register::t8, wordSize * i));
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::v1, Register::t9, wordSize * i));
         }
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::t8, Register::t8, wordSize * UNROLL));
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addiu, Register::t9, Register::t9, wordSize * UNROLL));
+        assemblies().push_back(std::make_unique<I_label_Inst>(Op::bne, Register::t9, Register::a1, loop));
+    }
+
+    for (int i = 0; i < range->count - looped; ++i) {
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::v1, Register::t8, wordSize * i));
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::v1, Register::t9, wordSize * i));
     }
 }
 
@@ -244,7 +269,7 @@ void MIPS::Add(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::addu, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::addu, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -256,7 +281,7 @@ void MIPS::Sub(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::subu, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::subu, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -268,7 +293,7 @@ void MIPS::Mul(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::mul, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::mul, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -280,7 +305,7 @@ void MIPS::Div(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::div, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::div, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -291,9 +316,9 @@ void MIPS::Mod(const IR::Inst &inst) {
 
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::div, Register::none, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::div, Register::none, reg1, reg2));
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::mfhi, regRes, Register::none, Register::none));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::mfhi, regRes, Register::none, Register::none));
     checkTempReg(res, regRes);
 }
 
@@ -305,7 +330,7 @@ void MIPS::And(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::and_, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::and_, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -317,7 +342,7 @@ void MIPS::Or(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::or_, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::or_, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -327,7 +352,7 @@ void MIPS::Neg(const IR::Inst &inst) {
 
     Register reg1 = getReg(arg1);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::subu, regRes, Register::zero, reg1));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::subu, regRes, Register::zero, reg1));
     checkTempReg(res, regRes);
 }
 
@@ -337,7 +362,7 @@ void MIPS::Not(const IR::Inst &inst) {
 
     Register reg1 = getReg(arg1);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::seq, regRes, Register::zero, reg1));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::seq, regRes, Register::zero, reg1));
     checkTempReg(res, regRes);
 }
 
@@ -346,29 +371,29 @@ void MIPS::LoadImd(const IR::Inst &inst) {
     auto imm = dynamic_cast<IR::ConstVal *>(inst.arg1.get());
 
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::li, regRes, Register::none, imm->value));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::li, regRes, Register::none, imm->value));
     checkTempReg(res, regRes);
 }
 
 void MIPS::GetInt(const IR::Inst &inst) {
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 5));
-    assemblies.push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 5));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
 }
 
 void MIPS::PrintInt(const IR::Inst &inst) {
     auto t = dynamic_cast<IR::Temp *>(inst.arg1.get());
 
-    assemblies.push_back(std::make_unique<R_Inst>(Op::move, Register::a0, getReg(t), Register::none));
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 1));
-    assemblies.push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::move, Register::a0, getReg(t), Register::none));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 1));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
 }
 
 void MIPS::PrintStr(const IR::Inst &inst) {
     auto str = dynamic_cast<IR::Str *>(inst.arg1.get());
 
-    assemblies.push_back(std::make_unique<I_label_Inst>(Op::la, Register::a0, Register::none, Label(str->toString())));
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 4));
-    assemblies.push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
+    assemblies().push_back(std::make_unique<I_label_Inst>(Op::la, Register::a0, Register::none, Label(str->toString())));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 4));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
 }
 
 void MIPS::Alloca(const IR::Inst &inst) {
@@ -377,14 +402,20 @@ void MIPS::Alloca(const IR::Inst &inst) {
 
     int byte = sizeOfType(var->type) * size->value;
 
-    if (!freeVarRegs.empty() && size->value == 1) {
+    // without a profile the first scalars declared get the $s registers, with one the hottest scalars
+    auto &state = funcState();
+    bool toReg = size->value == 1 && (state.profiled ? state.hotVars.count(*var) != 0 : !freeVarRegs().empty());
+
+    if (toReg && state.profiled && varToRegs().count(*var)) {
+        // the same Var in a sibling scope keeps its register
+    } else if (toReg) {
         // try adding the var to the map
-        Register r = freeVarRegs.front();
-        freeVarRegs.pop();
-        varToRegs[*var] = r;
+        Register r = freeVarRegs().front();
+        freeVarRegs().pop();
+        varToRegs()[*var] = r;
     } else {
-        StackMemory::curOffset += byte;
-        StackMemory::varToOffset[*var] = StackMemory::curOffset;
+        StackMemory::curOffset() += byte;
+        StackMemory::varToOffset()[*var] = StackMemory::curOffset();
     }
 }
 
@@ -394,8 +425,8 @@ void MIPS::Load(const IR::Inst &inst) {
 
     Register regRes = newReg(temp);
 
-    auto varReg = varToRegs.find(*var);
-    if (varReg == varToRegs.end()) {
+    auto varReg = varToRegs().find(*var);
+    if (varReg == varToRegs().end()) {
         // const index of array
         int arrayOffset = 0;
         if (inst.arg2) {
@@ -404,12 +435,12 @@ void MIPS::Load(const IR::Inst &inst) {
         }
 
         if (var->depth == 0) {
-            assemblies.push_back(std::make_unique<I_label_Inst>(Op::lw, regRes, Register::none, Label(var->name), arrayOffset));
+            assemblies().push_back(std::make_unique<I_label_Inst>(Op::lw, regRes, Register::none, Label(var->name), arrayOffset));
         } else {
-            assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, regRes, Register::sp, -getStackOffset(var) + arrayOffset));
+            assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, regRes, Register::sp, -getStackOffset(var) + arrayOffset));
         }
     } else {
-        assemblies.push_back(std::make_unique<R_Inst>(Op::move, regRes, varReg->second, Register::none));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::move, regRes, varReg->second, Register::none));
     }
 
     checkTempReg(temp, regRes);
@@ -422,34 +453,34 @@ void MIPS::LoadPtr(const IR::Inst &inst) {
 
     Register regAddr = getReg(addr);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, regRes, regAddr, offset ? offset->value * sizeOfType(res->type) : 0));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, regRes, regAddr, offset ? offset->value * sizeOfType(res->type) : 0));
     checkTempReg(res, regRes);
 }
 
 void MIPS::Br(const IR::Inst &inst) {
     auto label = Label(dynamic_cast<IR::Label *>(inst.arg1.get()));
-    assemblies.push_back(std::make_unique<J_Inst>(Op::j, label));
+    assemblies().push_back(std::make_unique<J_Inst>(Op::j, label));
 }
 
 void MIPS::Bif0(const IR::Inst &inst) {
     auto arg1 = dynamic_cast<IR::Temp *>(inst.arg1.get());
     auto label = Label(dynamic_cast<IR::Label *>(inst.arg2.get()));
 
-    assemblies.push_back(std::make_unique<I_label_Inst>(Op::beqz, getReg(arg1), Register::none, label));
+    assemblies().push_back(std::make_unique<I_label_Inst>(Op::beqz, getReg(arg1), Register::none, label));
 }
 
 void MIPS::Call(const IR::Inst &inst) {
     auto func = Label(dynamic_cast<IR::Label *>(inst.arg1.get()));
 
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::sp, Register::sp, -StackMemory::curOffset));
-    StackMemory::offsetStack.push(StackMemory::curOffset);
-    StackMemory::curOffset = 0;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::sp, Register::sp, -StackMemory::curOffset()));
+    StackMemory::offsetStack().push(StackMemory::curOffset());
+    StackMemory::curOffset() = 0;
 
     // save $sp $ra
-    StackMemory::curOffset += wordSize;
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::sp, Register::sp, -StackMemory::curOffset));
-    StackMemory::curOffset += wordSize;
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::ra, Register::sp, -StackMemory::curOffset));
+    StackMemory::curOffset() += wordSize;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::sp, Register::sp, -StackMemory::curOffset()));
+    StackMemory::curOffset() += wordSize;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::ra, Register::sp, -StackMemory::curOffset()));
 
     // save tempRegs
     // Only save used tempRegs, but we still allocate MAX_TEMP_REGS for stack of called function.
@@ -457,116 +488,116 @@ void MIPS::Call(const IR::Inst &inst) {
     // I choose to use more stack memory, but fewer instructions.
     // Another way is, before jal , save the number of used tempRegs to a realReg $?,
     // use the realReg $? to locate parameters instead of $sp. (slower but less memory use of stack)
-    for (auto &[tempId, reg]: tempToRegs) {
-        StackMemory::curOffset += wordSize;
-        assemblies.push_back(std::make_unique<I_imm_Inst>(
-                Op::sw, reg, Register::sp, -StackMemory::curOffset));
+    for (auto &[tempId, reg]: tempToRegs()) {
+        StackMemory::curOffset() += wordSize;
+        assemblies().push_back(std::make_unique<I_imm_Inst>(
+                Op::sw, reg, Register::sp, -StackMemory::curOffset()));
     }
 
-    StackMemory::curOffset += wordSize * (MAX_TEMP_REGS - static_cast<int>(tempToRegs.size()));
+    StackMemory::curOffset() += wordSize * (MAX_TEMP_REGS - static_cast<int>(tempToRegs().size()));
 
-    for (auto &[var, reg]: varToRegs) {
-        StackMemory::curOffset += wordSize;
-        assemblies.push_back(std::make_unique<I_imm_Inst>(
-                Op::sw, reg, Register::sp, -StackMemory::curOffset));
+    for (auto &[var, reg]: varToRegs()) {
+        StackMemory::curOffset() += wordSize;
+        assemblies().push_back(std::make_unique<I_imm_Inst>(
+                Op::sw, reg, Register::sp, -StackMemory::curOffset()));
     }
 
     // jal to function body
-    assemblies.push_back(std::make_unique<J_Inst>(Op::jal, func));
+    assemblies().push_back(std::make_unique<J_Inst>(Op::jal, func));
 
     // restore varRegs
-    for (auto i = varToRegs.rbegin(); i != varToRegs.rend(); ++i) {
-        assemblies.push_back(std::make_unique<I_imm_Inst>(
-                Op::lw, i->second, Register::sp, -StackMemory::curOffset));
-        StackMemory::curOffset -= wordSize;
+    for (auto i = varToRegs().rbegin(); i != varToRegs().rend(); ++i) {
+        assemblies().push_back(std::make_unique<I_imm_Inst>(
+                Op::lw, i->second, Register::sp, -StackMemory::curOffset()));
+        StackMemory::curOffset() -= wordSize;
     }
 
-    StackMemory::curOffset -= wordSize * (MAX_TEMP_REGS - static_cast<int>(tempToRegs.size()));
+    StackMemory::curOffset() -= wordSize * (MAX_TEMP_REGS - static_cast<int>(tempToRegs().size()));
 
     // restore tempRegs
-    for (auto i = tempToRegs.rbegin(); i != tempToRegs.rend(); ++i) {
-        assemblies.push_back(std::make_unique<I_imm_Inst>(
-                Op::lw, i->second, Register::sp, -StackMemory::curOffset));
-        StackMemory::curOffset -= wordSize;
+    for (auto i = tempToRegs().rbegin(); i != tempToRegs().rend(); ++i) {
+        assemblies().push_back(std::make_unique<I_imm_Inst>(
+                Op::lw, i->second, Register::sp, -StackMemory::curOffset()));
+        StackMemory::curOffset() -= wordSize;
     }
 
     // restore $ra $sp
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::ra, Register::sp, -StackMemory::curOffset));
-    StackMemory::curOffset -= wordSize;
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::sp, Register::sp, -StackMemory::curOffset));
-    StackMemory::curOffset -= wordSize;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::ra, Register::sp, -StackMemory::curOffset()));
+    StackMemory::curOffset() -= wordSize;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::sp, Register::sp, -StackMemory::curOffset()));
+    StackMemory::curOffset() -= wordSize;
 
-    // StackMemory::curOffset -= SymTab::find(func.nameAndId)->params.size() * wordSize;
+    // StackMemory::curOffset() -= SymTab::find(func.nameAndId)->params.size() * wordSize;
     // deAllocate stack for call
-    StackMemory::curOffset = StackMemory::offsetStack.top();
-    StackMemory::offsetStack.pop();
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::sp, Register::sp, StackMemory::curOffset));
+    StackMemory::curOffset() = StackMemory::offsetStack().top();
+    StackMemory::offsetStack().pop();
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::sp, Register::sp, StackMemory::curOffset()));
 }
 
 void MIPS::PushParam(const IR::Inst &inst) {
     auto param = dynamic_cast<IR::Temp *>(inst.arg1.get());
 
-    // set function's parameters to varToOffset is done in MIPS.cpp
-    StackMemory::curOffset += wordSize;
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(param), Register::sp, -StackMemory::curOffset));
+    // set function's parameters to varToOffset() is done in MIPS.cpp
+    StackMemory::curOffset() += wordSize;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, getReg(param), Register::sp, -StackMemory::curOffset()));
 }
 
 void MIPS::PushAddressParam(const IR::Inst &inst) {
     auto varAddr = dynamic_cast<IR::Var *>(inst.arg1.get());
 
-    // set function's parameters to varToOffset is done in MIPS.cpp
+    // set function's parameters to varToOffset() is done in MIPS.cpp
     if (varAddr->depth == 0) {
         if (auto constOffset = dynamic_cast<IR::ConstVal *>(inst.arg2.get())) {
             int offset = constOffset->value * wordSize;
-            assemblies.push_back(std::make_unique<I_label_Inst>(Op::la, Register::fp, Register::none, Label(varAddr->name), offset));
+            assemblies().push_back(std::make_unique<I_label_Inst>(Op::la, Register::fp, Register::none, Label(varAddr->name), offset));
         } else {
             auto dynamicOffset = dynamic_cast<IR::Temp *>(inst.arg2.get());
-            assemblies.push_back(std::make_unique<I_label_Inst>(Op::la, Register::fp, getReg(dynamicOffset), Label(varAddr->name)));
+            assemblies().push_back(std::make_unique<I_label_Inst>(Op::la, Register::fp, getReg(dynamicOffset), Label(varAddr->name)));
         }
     } else {
         if (auto constOffset = dynamic_cast<IR::ConstVal *>(inst.arg2.get())) {
             // int offset = constOffset->value * wordSize - getStackOffset(varAddr);
             if (varAddr->symType == SymType::Param && !varAddr->dims.empty()) {
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(varAddr)));
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::fp, Register::fp, constOffset->value * wordSize));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(varAddr)));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::fp, Register::fp, constOffset->value * wordSize));
             } else {
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::fp, Register::sp,
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::fp, Register::sp,
                                                                   constOffset->value * wordSize - getStackOffset(varAddr)));
             }
         } else {
             if (varAddr->symType == SymType::Param && !varAddr->dims.empty()) {
                 auto dynamicOffset = dynamic_cast<IR::Temp *>(inst.arg2.get());
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(varAddr)));
-                assemblies.push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::fp, getReg(dynamicOffset)));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, Register::fp, Register::sp, -getStackOffset(varAddr)));
+                assemblies().push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::fp, getReg(dynamicOffset)));
             } else {
                 auto dynamicOffset = dynamic_cast<IR::Temp *>(inst.arg2.get());
-                assemblies.push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::fp, Register::sp, -getStackOffset(varAddr)));
-                assemblies.push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::fp, getReg(dynamicOffset)));
+                assemblies().push_back(std::make_unique<I_imm_Inst>(Op::addi, Register::fp, Register::sp, -getStackOffset(varAddr)));
+                assemblies().push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::fp, getReg(dynamicOffset)));
             }
         }
     }
 
-    StackMemory::curOffset += wordSize;
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::fp, Register::sp, -StackMemory::curOffset));
+    StackMemory::curOffset() += wordSize;
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sw, Register::fp, Register::sp, -StackMemory::curOffset()));
 }
 
 void MIPS::Ret(const IR::Inst &inst) {
     auto ret = dynamic_cast<IR::Temp *>(inst.arg1.get());
     if (ret) {
-        assemblies.push_back(std::make_unique<R_Inst>(Op::move, Register::v0, getReg(ret), Register::none));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::move, Register::v0, getReg(ret), Register::none));
     }
-    assemblies.push_back(std::make_unique<R_Inst>(Op::jr, Register::none, Register::ra, Register::none));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::jr, Register::none, Register::ra, Register::none));
 }
 
 void MIPS::RetMain(const IR::Inst &inst) {
     auto ret = dynamic_cast<IR::Temp *>(inst.arg1.get());
     if (ret) {
-        assemblies.push_back(std::make_unique<R_Inst>(Op::move, Register::a0, getReg(ret), Register::none));
-        assemblies.push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 17));
-        assemblies.push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::move, Register::a0, getReg(ret), Register::none));
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 17));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
     } else {
-        assemblies.push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 10));
-        assemblies.push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::li, Register::v0, Register::none, 10));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::syscall, Register::none, Register::none, Register::none));
     }
 }
 
@@ -576,7 +607,7 @@ void MIPS::NewMove(const IR::Inst &inst) {
 
     Register regRes = newReg(res);
     Register reg1 = getReg(arg1);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::move, regRes, reg1, Register::none));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::move, regRes, reg1, Register::none));
     checkTempReg(res, regRes);
 }
 
@@ -588,7 +619,7 @@ void MIPS::Leq(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::sle, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::sle, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -600,7 +631,7 @@ void MIPS::Lss(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::slt, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::slt, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -612,7 +643,7 @@ void MIPS::Geq(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::sge, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::sge, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -624,7 +655,7 @@ void MIPS::Gre(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::sgt, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::sgt, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -636,7 +667,7 @@ void MIPS::Eql(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::seq, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::seq, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -648,7 +679,7 @@ void MIPS::Neq(const IR::Inst &inst) {
     Register reg1 = getReg(arg1);
     Register reg2 = getReg(arg2);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<R_Inst>(Op::sne, regRes, reg1, reg2));
+    assemblies().push_back(std::make_unique<R_Inst>(Op::sne, regRes, reg1, reg2));
     checkTempReg(res, regRes);
 }
 
@@ -656,7 +687,7 @@ void MIPS::Bif1(const IR::Inst &inst) {
     auto arg1 = dynamic_cast<IR::Temp *>(inst.arg1.get());
     auto label = Label(dynamic_cast<IR::Label *>(inst.arg2.get()));
 
-    assemblies.push_back(std::make_unique<I_label_Inst>(Op::bne, getReg(arg1), Register::zero, label));
+    assemblies().push_back(std::make_unique<I_label_Inst>(Op::bne, getReg(arg1), Register::zero, label));
 }
 
 void MIPS::LoadDynamic(const IR::Inst &inst) {
@@ -667,10 +698,10 @@ void MIPS::LoadDynamic(const IR::Inst &inst) {
     Register regOffset = getReg(offset);
     Register regValue = newReg(value);
     if (var->depth == 0) {
-        assemblies.push_back(std::make_unique<I_label_Inst>(Op::lw, regValue, regOffset, Label(var->name)));
+        assemblies().push_back(std::make_unique<I_label_Inst>(Op::lw, regValue, regOffset, Label(var->name)));
     } else {
-        assemblies.push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::sp, regOffset));
-        assemblies.push_back(std::make_unique<I_imm_Inst>(Op::lw, regValue, Register::fp, -getStackOffset(var)));
+        assemblies().push_back(std::make_unique<R_Inst>(Op::add, Register::fp, Register::sp, regOffset));
+        assemblies().push_back(std::make_unique<I_imm_Inst>(Op::lw, regValue, Register::fp, -getStackOffset(var)));
     }
     checkTempReg(value, regValue);
 }
@@ -681,7 +712,7 @@ void MIPS::MulImd(const IR::Inst &inst) {
     auto imm = dynamic_cast<IR::ConstVal *>(inst.arg2.get());
 
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::mul, regRes, getReg(arg1), imm->value));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::mul, regRes, getReg(arg1), imm->value));
     checkTempReg(res, regRes);
 }
 
@@ -691,6 +722,6 @@ void MIPS::Mult4(const IR::Inst &inst) {
 
     Register reg1 = getReg(arg1);
     Register regRes = newReg(res);
-    assemblies.push_back(std::make_unique<I_imm_Inst>(Op::sll, regRes, reg1, 2));
+    assemblies().push_back(std::make_unique<I_imm_Inst>(Op::sll, regRes, reg1, 2));
     checkTempReg(res, regRes);
 }
@@ -6,6 +6,8 @@
 #define INSTRUCTION_H
 
 #include "MIPS.h"
+
+#include <string_view>
 #include "Register.h"
 
 namespace MIPS {
@@ -53,7 +55,7 @@ enum class Op {
     slti,
 };
 
-std::string opToString(Op e);
+std::string_view opName(Op e);
 
 struct Instruction : public Assembly {
     Op op;
@@ -68,7 +70,7 @@ struct R_Inst : public Instruction {
 
     R_Inst(Op op, Register rd, Register rs, Register rt);
 
-    std::string toString() override;
+    void emit(Emitter &out) const override;
 };
 
 struct I_imm_Inst : public Instruction {
@@ -78,7 +80,7 @@ struct I_imm_Inst : public Instruction {
 
     I_imm_Inst(Op op, Register rt, Register rs, int immediate);
 
-    std::string toString() override;
+    void emit(Emitter &out) const override;
 };
 
 struct I_label_Inst : public Instruction {
@@ -89,7 +91,7 @@ struct I_label_Inst : public Instruction {
 
     I_label_Inst(Op op, Register rs, Register rt, Label label, int offset = 0);
 
-    std::string toString() override;
+    void emit(Emitter &out) const override;
 };
 
 struct J_Inst : public Instruction {
@@ -97,13 +99,16 @@ struct J_Inst : public Instruction {
 
     explicit J_Inst(Op op, Label label);
 
-    std::string toString() override;
+    void emit(Emitter &out) const override;
 };
 
 void InStack(const IR::Inst &);
 void OutStack(const IR::Inst &);
 void Store(const IR::Inst &);
 void StoreDynamic(const IR::Inst &);
+// $t8 $t9 $v1 $a1 are never allocated, Fill and CopyData use them for loops
+void Fill(const IR::Inst &);
+void CopyData(const IR::Inst &);
 void Add(const IR::Inst &);
 void Sub(const IR::Inst &);
 void Mul(const IR::Inst &);
@@ -3,37 +3,54 @@
 //
 #include "MIPS.h"
 
+#include <algorithm>
 #include <iostream>
 #include <utility>
 
-#include "config.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
 #include "Instruction.h"
 #include "Memory.h"
+#include "tools/Stats.h"
 
 
 #include <string>
 
 using namespace MIPS;
 
-int MIPS::curDepth = 1;
+namespace {
+thread_local FuncState *currentFuncState = nullptr;
+}
 
-std::ofstream MIPS::mipsFileStream;
-std::vector<std::unique_ptr<Assembly>> MIPS::assemblies; // maybe use List is faster in optimization
+FuncState &MIPS::funcState() {
+    return *currentFuncState;
+}
 
-void MIPS::output(const std::string &str, bool newLine) {
-#if defined(FILEOUT_MIPS)
-    mipsFileStream << str;
-    if (newLine) {
-        mipsFileStream << '\n';
-    }
-#endif
-#if defined(STDOUT_MIPS)
-    std::cout << str;
-    if (newLine) {
-        std::cout << '\n';
+int &MIPS::curDepth() {
+    return funcState().curDepth;
+}
+
+std::ofstream &MIPS::mipsFileStream() {
+    return Context::cur().mips.mipsFileStream;
+}
+
+std::vector<std::unique_ptr<Assembly>> &MIPS::assemblies() {
+    return funcState().assemblies;
+}
+
+MIPS::State::State() {
+    for (auto &peephole: MIPS::peepholes()) {
+        peepholes.push_back(&peephole);
     }
-#endif
+}
+
+Emitter &MIPS::emitter() {
+    return Context::cur().mips.emitter;
+}
+
+void MIPS::output(std::string_view str) {
+    emitter() << str;
+    emitter().endLine();
 }
 
 Label::Label(std::string name_and_id) :
@@ -42,76 +59,208 @@ Label::Label(std::string name_and_id) :
 Label::Label(const IR::Label *label) :
     nameAndId(label->nameAndId) {}
 
-std::string Label::toString() {
-    return nameAndId + ":";
+void Label::emit(Emitter &out) const {
+    out << nameAndId << ':';
+}
+
+namespace {
+// runs of equal words at least this long are written as "value:count"
+constexpr std::size_t MIN_WORD_RUN = 4;
+
+// a: .space 4000        all zero
+// b: .word 1, 2, 3
+// .word 0:96            MARS only takes "value:count" as a whole directive
+// .word 7
+void outputWords(std::string_view name, const std::vector<int> &values) {
+    auto &out = emitter();
+    out << name << ": ";
+    if (std::all_of(values.begin(), values.end(), [](int v) { return v == 0; })) {
+        out << ".space " << static_cast<int>(values.size()) * wordSize;
+        out.endLine();
+        return;
+    }
+
+    bool labelLine = true;
+    bool inList = false;
+    for (std::size_t i = 0, j; i < values.size(); i = j) {
+        for (j = i + 1; j < values.size() && values[j] == values[i]; ++j) {}
+
+        if (j - i >= MIN_WORD_RUN) {
+            if (!labelLine) {
+                out.endLine();
+            }
+            out << ".word " << values[i] << ':' << static_cast<int>(j - i);
+            inList = false;
+        } else {
+            for (auto k = i; k < j; ++k) {
+                if (inList) {
+                    out << ", ";
+                } else {
+                    if (!labelLine) {
+                        out.endLine();
+                    }
+                    out << ".word ";
+                    inList = true;
+                }
+                out << values[k];
+            }
+        }
+        labelLine = false;
+    }
+    out.endLine();
+}
+
+void outputGlobVars(const IR::Module &module) {
+    for (auto &[name, globVar]: module.getGlobVars()) {
+        outputWords(name, globVar.initVal);
+    }
+}
+
+bool hasConstData() {
+    return !IR::Str::MIPS_strings().empty() || !IR::ArrayData::MIPS_arrays().empty();
+}
+
+// output the strings and arrays not in .data yet, and free them
+void outputConstData() {
+    auto &state = Context::cur().mips;
+    auto &out = emitter();
+
+    auto &strings = IR::Str::MIPS_strings();
+    for (const auto &str: strings) {
+        out << "str_" << state.outputStrings++ << ": .asciiz " << str;
+        out.endLine();
+    }
+    strings.clear();
+
+    auto &arrays = IR::ArrayData::MIPS_arrays();
+    for (const auto &words: arrays) {
+        outputWords("arr_" + std::to_string(state.outputArrays++), words);
+    }
+    arrays.clear();
+}
+
+void outputText(const FuncState &state) {
+    Stats::Timer timer("genMIPS.emit");
+    auto &out = emitter();
+    for (auto &assem: state.assemblies) {
+        assem->emit(out);
+        out.endLine();
+    }
 }
+} // namespace
 
 void MIPS::genMIPS(const IR::Module &module) {
+    Stats::Timer timer("genMIPS");
     /*---- .data generate & output ----------------------*/
     output("#### MIPS ####");
     output(".data");
-    for (auto &[name, globVar]: module.getGlobVars()) {
-        output(name + ": .word ", false);
-        for (auto i: globVar.initVal) {
-            output(std::to_string(i) + ", ", false);
-        }
-        output("");
+    outputGlobVars(module);
+    outputConstData();
+
+    /*----- .text generate & optimize ---------------------*/
+    // functions share no backend state, lower them in parallel
+    // main first, then other functions in IR order
+    std::vector<const IR::Function *> funcs{&module.getMainFunction()};
+    for (auto &func: module.getFunctions()) {
+        funcs.push_back(func.get());
     }
-    int i = 0;
-    for (const auto &str: IR::Str::MIPS_strings) {
-        output("str_" + std::to_string(i) + ": .asciiz " + str);
-        i++;
+
+    std::vector<FuncState> states(funcs.size());
+    Context::cur().parallelFor(funcs.size(), [&](std::size_t i) {
+        genFunction(*funcs[i], i == 0, states[i]);
+    });
+
+    /*----- .text output  ---------------------*/
+    output("");
+    output(".text");
+    for (auto &state: states) {
+        outputText(state);
     }
+}
 
-    /*----- .text generate ---------------------*/
+void MIPS::genGlobals(const IR::Module &module) {
+    Stats::Timer timer("genMIPS");
+    output("#### MIPS ####");
+    output(".data");
+    outputGlobVars(module);
     output("");
     output(".text");
-    // main
-    for (auto &basicBlock: module.getMainFunction().getBasicBlocks()) {
-        assemblies.push_back(std::make_unique<Label>(basicBlock->label.nameAndId));
-        for (auto &inst: basicBlock->instructions) {
-            irToMips(inst);
-        }
+    // main comes last in the source, jump over the functions streamed before it
+    J_Inst(Op::j, Label("main")).emit(emitter());
+    emitter().endLine();
+}
+
+void MIPS::genStreamFunction(const IR::Function &func, bool isMain) {
+    Stats::Timer timer("genMIPS");
+    FuncState state;
+    genFunction(func, isMain, state);
+
+    if (hasConstData()) {
+        output(".data");
+        outputConstData();
+        output(".text");
     }
+    outputText(state);
+}
 
-    // other function
-    for (auto &func: module.getFunctions()) {
-        clearRegs();
+void MIPS::genFunction(const IR::Function &func, bool isMain, FuncState &state) {
+    Stats::Timer timer("genMIPS.function", func.getName());
+    FuncState *prev = std::exchange(currentFuncState, &state);
+    state.name = func.getName();
+
+    auto profile = Context::cur().mips.profile;
+    if (profile && profile->has(state.name)) {
+        auto vars = Profile::hotVars(func, *profile);
+        state.profiled = true;
+        state.hotVars = {vars.begin(), vars.begin() + std::min<std::size_t>(vars.size(), MAX_VAR_REGS)};
+    }
+
+    if (!isMain) {
         // Use part of tempRegs, but move stackOffset for MAX_TEMP_REGS.
-        StackMemory::curOffset = wordSize * (2 + MAX_TEMP_REGS + MAX_VAR_REGS);
-        StackMemory::varToOffset.clear();
+        StackMemory::curOffset() = wordSize * (2 + MAX_TEMP_REGS + MAX_VAR_REGS);
 
-        // set function's parameters to varToOffset
+        // set function's parameters to varToOffset()
         // stack memory map explain is in markdown and Memory.h
         int offset = 0;
-        for (auto &[ident, sym]: func->getParams()) {
-            StackMemory::varToOffset.emplace(IR::Var(ident, 1, false, sym->dims, sym->type), -offset);
+        for (auto &[ident, sym]: func.getParams()) {
+            StackMemory::varToOffset().emplace(IR::Var(ident, 1, false, sym->dims, sym->type), -offset);
             offset += sizeOfType(sym->type);
         }
+    }
 
-        for (auto &basicBlock: func->getBasicBlocks()) {
-            assemblies.push_back(std::make_unique<Label>(basicBlock->label.nameAndId));
+    std::int64_t irInstructions = 0;
+    {
+        Stats::Timer timer("genMIPS.lower");
+        for (auto &basicBlock: func.getBasicBlocks()) {
+            assemblies().push_back(std::make_unique<Label>(basicBlock->label.nameAndId));
             for (auto &inst: basicBlock->instructions) {
                 irToMips(inst);
             }
+            irInstructions += static_cast<std::int64_t>(basicBlock->instructions.size());
         }
     }
+    auto lowered = static_cast<std::int64_t>(assemblies().size());
 
     /*----- .text optimize ---------------------*/
-    // TODO: these two cause bugs!
-    // while (allMergeR_Move()) {}
-    // while (allMergeMove_R_rs()) {}
-    // while (allMergeLi_Move()) {}
-
-
-    // good optimize here
-    while (allMergeMove_R_rt()) {}
-    while (allMergeLi_R()) {}
+    // every function starts with a Label, so no merge crosses functions
+    {
+        Stats::Timer timer("genMIPS.peephole");
+        for (auto peephole: Context::cur().mips.peepholes) {
+            while (peephole->pass()) {}
+            if (peephole->after != Stats::Counter::COUNT) {
+                Stats::count(peephole->after, static_cast<std::int64_t>(assemblies().size()));
+            }
+        }
+    }
 
-    /*----- .text output  ---------------------*/
-    for (auto &assem: assemblies) {
-        output(assem->toString());
+    if (Stats::enabled()) {
+        Stats::count(Stats::Counter::Functions);
+        Stats::count(Stats::Counter::IRInstructions, irInstructions);
+        Stats::count(Stats::Counter::Assemblies, lowered);
+        Stats::addFunction({state.name, irInstructions, lowered, static_cast<std::int64_t>(assemblies().size())});
     }
+
+    currentFuncState = prev;
 }
 
 Op rOp_ImmOp(Op rOp) {
@@ -141,14 +290,103 @@ std::unique_ptr<I_imm_Inst> MIPS::mergeLi_R(const I_imm_Inst &li, const R_Inst &
     return std::make_unique<I_imm_Inst>(rOp_ImmOp(r.op), r.rd, r.rs, li.immediate);
 }
 
+namespace {
+using AssemblyIt = std::vector<std::unique_ptr<Assembly>>::iterator;
+
+// what an assembly does with a register, see deadAfter
+enum class Access {
+    None,
+    Read,    // reads it, maybe writes it too
+    Write,   // overwrites it without reading
+    Unknown, // a label or a jump, the register may be read on another path
+};
+
+Access access(const Assembly *assem, Register reg) {
+    auto inst = dynamic_cast<const Instruction *>(assem);
+    if (!inst) {
+        return Access::Unknown;
+    }
+
+    Register reads[2]{Register::none, Register::none};
+    Register write = Register::none;
+    switch (inst->op) {
+        case Op::j:
+        case Op::jal:
+        case Op::jr:
+        case Op::bgtz:
+        case Op::beqz:
+        case Op::bne:
+            return Access::Unknown;
+        case Op::syscall:
+            // reads the service in $v0 and the argument in $a0, getint writes $v0
+            return reg == Register::v0 || reg == Register::a0 ? Access::Read : Access::None;
+        default:
+            break;
+    }
+    if (auto r = dynamic_cast<const R_Inst *>(inst)) {
+        reads[0] = r->rs;
+        reads[1] = r->rt;
+        write = r->rd;
+    } else if (auto imm = dynamic_cast<const I_imm_Inst *>(inst)) {
+        reads[0] = imm->rs;
+        if (imm->op == Op::sw) {
+            reads[1] = imm->rt;
+        } else {
+            write = imm->rt;
+        }
+    } else if (auto label = dynamic_cast<const I_label_Inst *>(inst)) {
+        // la, lw and sw take the data register in rs and the index register in rt
+        reads[0] = label->rt;
+        if (label->op == Op::sw) {
+            reads[1] = label->rs;
+        } else {
+            write = label->rs;
+        }
+    } else {
+        return Access::Unknown;
+    }
+
+    if (reads[0] == reg || reads[1] == reg) {
+        return Access::Read;
+    }
+    return write == reg ? Access::Write : Access::None;
+}
+
+// $t0 ~ $t{MAX_TEMP_REGS-1}, each holds one IR::Temp, which getReg frees at its only use
+bool isTempReg(Register reg) {
+    return reg >= Register::t0 && static_cast<int>(reg) < static_cast<int>(Register::t0) + MAX_TEMP_REGS;
+}
+
+// pos reads reg, and the value reg holds after pos is never read again:
+// the rest of the basic block overwrites reg before reading it,
+// or reg is a temp register, whose value pos has used up, see getReg.
+// Other registers may live across labels and jumps.
+bool deadAfter(AssemblyIt pos, Register reg) {
+    for (auto it = pos + 1; it != assemblies().end(); ++it) {
+        switch (access(it->get(), reg)) {
+            case Access::None:
+                continue;
+            case Access::Write:
+                return true;
+            case Access::Read:
+                return false;
+            case Access::Unknown:
+                return isTempReg(reg);
+        }
+    }
+    return isTempReg(reg);
+}
+} // namespace
+
 // merge immediate instructions
 bool MIPS::allMergeLi_R() {
     // li   $t1 1
     // addu $t2 $t0 $t1
     // ------------------
     // addiu $t2 $t0 1
+    // $t1 must be dead after addu, and not be $t0
     bool flag = false;
-    for (auto assem1 = assemblies.begin(); assem1 != assemblies.end() - 1; ++assem1) {
+    for (auto assem1 = assemblies().begin(); assem1 < assemblies().end() - 1; ++assem1) {
         auto assem2 = assem1 + 1;
 
         auto inst1 = dynamic_cast<Instruction *>(assem1->get());
@@ -164,9 +402,10 @@ bool MIPS::allMergeLi_R() {
                 continue;
             }
 
-            if (r && r->rt == li->rt && rOp_ImmOp(r->op) != Op::none) {
+            if (r && r->rt == li->rt && r->rs != li->rt && rOp_ImmOp(r->op) != Op::none
+                && (r->rd == li->rt || deadAfter(assem2, li->rt))) {
                 *assem2 = mergeLi_R(*li, *r);
-                assem1 = assemblies.erase(assem1);
+                assem1 = assemblies().erase(assem1);
                 flag = true;
             }
         }
@@ -175,8 +414,13 @@ bool MIPS::allMergeLi_R() {
 }
 
 bool MIPS::allMergeLi_Move() {
+    // li   $t1 1
+    // move $s0 $t1
+    // ------------------
+    // li   $s0 1
+    // $t1 must be dead after move
     bool flag = false;
-    for (auto assem1 = assemblies.begin(); assem1 != assemblies.end() - 1; ++assem1) {
+    for (auto assem1 = assemblies().begin(); assem1 < assemblies().end() - 1; ++assem1) {
         auto assem2 = assem1 + 1;
 
         auto inst1 = dynamic_cast<Instruction *>(assem1->get());
@@ -185,9 +429,9 @@ bool MIPS::allMergeLi_Move() {
         if (inst1 && inst1->op == Op::li && inst2 && inst2->op == Op::move) {
             auto li = dynamic_cast<I_imm_Inst *>(inst1);
             auto move = dynamic_cast<R_Inst *>(inst2);
-            if (li->rt == move->rs) {
+            if (li->rt == move->rs && (move->rd == li->rt || deadAfter(assem2, li->rt))) {
                 li->rt = move->rd;
-                assemblies.erase(assem2);
+                assemblies().erase(assem2);
                 flag = true;
             }
         }
@@ -198,8 +442,13 @@ bool MIPS::allMergeLi_Move() {
 
 // Load
 bool MIPS::allMergeMove_R_rs() {
+    // move $t1 $s0
+    // addu $t2 $t1 $t3
+    // ------------------
+    // addu $t2 $s0 $t3
+    // $t1 must be dead after addu
     bool flag = false;
-    for (auto assem1 = assemblies.begin(); assem1 != assemblies.end() - 1; ++assem1) {
+    for (auto assem1 = assemblies().begin(); assem1 < assemblies().end() - 1; ++assem1) {
         auto assem2 = assem1 + 1;
 
         auto inst1 = dynamic_cast<Instruction *>(assem1->get());
@@ -209,9 +458,12 @@ bool MIPS::allMergeMove_R_rs() {
             auto move = dynamic_cast<R_Inst *>(inst1);
 
             if (auto cal = dynamic_cast<R_Inst *>(inst2)) {
-                if (cal->rs == move->rd) {
+                if (cal->rs == move->rd && (cal->rd == move->rd || deadAfter(assem2, move->rd))) {
                     cal->rs = move->rs;
-                    assem1 = assemblies.erase(assem1);
+                    if (cal->rt == move->rd) {
+                        cal->rt = move->rs;
+                    }
+                    assem1 = assemblies().erase(assem1);
                     flag = true;
                 }
             }
@@ -222,8 +474,13 @@ bool MIPS::allMergeMove_R_rs() {
 }
 
 bool MIPS::allMergeMove_R_rt() {
+    // move $t1 $s0
+    // addu $t2 $t3 $t1
+    // ------------------
+    // addu $t2 $t3 $s0
+    // $t1 must be dead after addu
     bool flag = false;
-    for (auto assem1 = assemblies.begin(); assem1 != assemblies.end() - 1; ++assem1) {
+    for (auto assem1 = assemblies().begin(); assem1 < assemblies().end() - 1; ++assem1) {
         auto assem2 = assem1 + 1;
 
         auto inst1 = dynamic_cast<Instruction *>(assem1->get());
@@ -233,9 +490,12 @@ bool MIPS::allMergeMove_R_rt() {
             auto move = dynamic_cast<R_Inst *>(inst1);
 
             if (auto cal = dynamic_cast<R_Inst *>(inst2)) {
-                if (cal->rt == move->rd) {
+                if (cal->rt == move->rd && (cal->rd == move->rd || deadAfter(assem2, move->rd))) {
                     cal->rt = move->rs;
-                    assem1 = assemblies.erase(assem1);
+                    if (cal->rs == move->rd) {
+                        cal->rs = move->rs;
+                    }
+                    assem1 = assemblies().erase(assem1);
                     flag = true;
                 }
             }
@@ -246,21 +506,27 @@ bool MIPS::allMergeMove_R_rt() {
 }
 
 bool MIPS::allMergeR_Move() {
+    // addu $t1 $t2 $t3
+    // move $s0 $t1
+    // ------------------
+    // addu $s0 $t2 $t3
+    // $t1 must be dead after move
     bool flag = false;
-    for (auto assem2 = assemblies.begin() + 1; assem2 != assemblies.end(); ++assem2) {
+    for (auto assem2 = assemblies().begin() + 1; assem2 != assemblies().end(); ++assem2) {
         auto assem1 = assem2 - 1;
 
         auto inst1 = dynamic_cast<Instruction *>(assem1->get());
         auto inst2 = dynamic_cast<Instruction *>(assem2->get());
 
-        // inst2 && inst2->op == Op::move && ...
-        if (inst1) {
+        if (inst1 && inst2 && inst2->op == Op::move) {
             auto move = dynamic_cast<R_Inst *>(inst2);
 
             if (auto cal = dynamic_cast<R_Inst *>(inst1)) {
-                if (cal->op != Op::move && cal->rd == move->rs) {
+                if (cal->op != Op::move && cal->rd == move->rs
+                    && (move->rd == move->rs || deadAfter(assem2, move->rs))) {
                     cal->rd = move->rd;
-                    assem2 = assemblies.erase(assem2);
+                    // back to cal, erase may return end()
+                    assem2 = assemblies().erase(assem2) - 1;
                     flag = true;
                 }
             }
@@ -270,6 +536,18 @@ bool MIPS::allMergeR_Move() {
     return flag;
 }
 
+const std::vector<MIPS::Peephole> &MIPS::peepholes() {
+    // each merge drops a register write, so it checks that the register is dead, see deadAfter
+    static const std::vector<Peephole> res{
+            {"mergeR_Move", allMergeR_Move, Stats::Counter::COUNT},
+            {"mergeMove_R_rs", allMergeMove_R_rs, Stats::Counter::COUNT},
+            {"mergeLi_Move", allMergeLi_Move, Stats::Counter::COUNT},
+            {"mergeMove_R_rt", allMergeMove_R_rt, Stats::Counter::AfterMergeMove_R_rt},
+            {"mergeLi_R", allMergeLi_R, Stats::Counter::AfterMergeLi_R},
+    };
+    return res;
+}
+
 void MIPS::irToMips(const IR::Inst &inst) {
     switch (inst.op) {
         case IR::Op::Empty:
@@ -286,6 +564,12 @@ void MIPS::irToMips(const IR::Inst &inst) {
         case IR::Op::StoreDynamic:
             StoreDynamic(inst);
             break;
+        case IR::Op::Fill:
+            Fill(inst);
+            break;
+        case IR::Op::CopyData:
+            CopyData(inst);
+            break;
         case IR::Op::Add:
             Add(inst);
             break;
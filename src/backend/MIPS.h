@@ -5,27 +5,86 @@
 #ifndef COMPILER_MIPS_H
 #define COMPILER_MIPS_H
 
+#include "Emitter.h"
+#include "Memory.h"
 #include "middle/IR.h"
+#include "middle/Profile.h"
+#include "Register.h"
+#include "tools/Stats.h"
 
 #include <fstream>
+#include <set>
 
 // init register at beginning
 namespace MIPS {
 struct I_imm_Inst;
 struct R_Inst;
+struct Peephole;
 
-extern int curDepth;
+int &curDepth();
 
 constexpr int wordSize = 4;
-extern std::ofstream mipsFileStream;
+std::ofstream &mipsFileStream();
 
 struct Assembly {
     virtual ~Assembly() = default;
 
-    virtual std::string toString() = 0;
+    // one line of assembly, without '\n'
+    virtual void emit(Emitter &out) const = 0;
 };
 
-extern std::vector<std::unique_ptr<Assembly>> assemblies;
+std::vector<std::unique_ptr<Assembly>> &assemblies();
+
+// lowering state of one function
+// each function is lowered into its own FuncState, functions may be lowered on different threads
+struct FuncState {
+    std::string name;
+    int curDepth{1};
+    int loopIdAllocator{}; // labels of loops made by the backend
+    std::vector<std::unique_ptr<Assembly>> assemblies; // maybe use List is faster in optimization
+
+    // Register.h
+    std::map<int, Register> tempToRegs;
+    std::queue<Register> freeTempRegs = cleanRegQueue<MAX_TEMP_REGS>(true);
+    std::map<IR::Var, Register> varToRegs;
+    std::queue<Register> freeVarRegs = cleanRegQueue<MAX_VAR_REGS>(false);
+    // the next temp loaded back from the stack goes to $k1, else $k0, see getReg
+    bool reloadK1{};
+    // with a profile of the function, only these scalars get $s registers, see Profile::hotVars
+    bool profiled{};
+    std::set<IR::Var> hotVars;
+
+    // Memory.h
+    std::unordered_map<IR::Var, int> varToOffset;
+    int curOffset{};
+    std::stack<int> offsetStack;
+};
+
+// the FuncState being lowered on the calling thread
+FuncState &funcState();
+
+// backend state of one compilation, owned by Context
+struct State {
+    std::ofstream mipsFileStream;
+    // declared after its sinks, so it flushes before they close
+    Emitter emitter;
+
+    // strings and arrays already in .data,
+    // IR::Str::MIPS_strings() and IR::ArrayData::MIPS_arrays() only keep the newer ones in streaming mode
+    int outputStrings{};
+    int outputArrays{};
+
+    // block frequencies to pick the variables in $s registers, nullptr hands them out in declaration order
+    const Profile::Frequencies *profile{};
+
+    // of peepholes(), genFunction runs these in this order, all of them by default, see Opt::Config
+    std::vector<const Peephole *> peepholes;
+
+    // emitter has no sinks, compile() adds those of Output::Config::mips
+    State();
+};
+
+Emitter &emitter();
 
 // Label for MIPS instruction
 struct Label : public Assembly {
@@ -35,7 +94,7 @@ struct Label : public Assembly {
 
     explicit Label(const IR::Label *label);
 
-    std::string toString() override;
+    void emit(Emitter &out) const override;
 };
 
 void irToMips(const IR::Inst &inst);
@@ -50,9 +109,29 @@ bool allMergeLi_Move();
 bool allMergeMove_R_rs();
 bool allMergeR_Move();
 
+// peephole pass on the assemblies() of a function, run by genFunction until it returns false
+struct Peephole {
+    const char *name;
+    bool (*pass)();
+    Stats::Counter after; // assemblies() counted after the pass, Stats::Counter::COUNT for none
+};
+
+// every peephole, in the order genFunction runs them by default
+const std::vector<Peephole> &peepholes();
+
+// lower func into state, with state bound to the calling thread
+void genFunction(const IR::Function &func, bool isMain, FuncState &state);
+
 void genMIPS(const IR::Module &module);
 
-void output(const std::string &str, bool newLine = true);
+// streaming mode, see CompUnit::stream
+// .data of the global variables, then .text starting with a jump to main (main comes last)
+void genGlobals(const IR::Module &module);
+// lower func and output it at once, strings and arrays it added go to .data first
+void genStreamFunction(const IR::Function &func, bool isMain);
+
+// one line into emitter()
+void output(std::string_view str);
 
 } // namespace MIPS
 #endif
@@ -3,14 +3,23 @@
 //
 
 #include "Memory.h"
+#include "MIPS.h"
+
 
 using namespace MIPS;
 
-std::unordered_map<IR::Var, int> StackMemory::varToOffset;
+std::unordered_map<IR::Var, int> &StackMemory::varToOffset() {
+    return funcState().varToOffset;
+}
 
-int StackMemory::curOffset;
-std::stack<int> StackMemory::offsetStack{};
+int &StackMemory::curOffset() {
+    return funcState().curOffset;
+}
+
+std::stack<int> &StackMemory::offsetStack() {
+    return funcState().offsetStack;
+}
 
 int MIPS::getStackOffset(const IR::Var *var) {
-    return StackMemory::varToOffset[*var];
+    return StackMemory::varToOffset()[*var];
 }
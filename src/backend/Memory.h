@@ -32,10 +32,10 @@ int getStackOffset(const IR::Var *var);
 // push/pop curOffset into/from stack<int> offsetStack
 namespace StackMemory {
 // clear when generating MIPS for a new Function
-extern std::unordered_map<IR::Var, int> varToOffset;
+std::unordered_map<IR::Var, int> &varToOffset();
 
-extern int curOffset;
-extern std::stack<int> offsetStack;
+int &curOffset();
+std::stack<int> &offsetStack();
 } // namespace StackMemory
 } // namespace MIPS
 
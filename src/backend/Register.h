@@ -8,6 +8,8 @@
 #include "middle/IR.h"
 #include <map>
 #include <queue>
+#include <string_view>
+#include <utility>
 
 
 #include <unordered_map>
@@ -56,7 +58,7 @@ enum class Register {
     gp,
     sp,
 
-    // if freeTempRegs is empty, use $fp to store/load temp into/from stack
+    // if freeTempRegs is empty, use $fp to store temp into stack, getReg loads it back into $k0 or $k1
     fp,
 
     ra,
@@ -68,11 +70,22 @@ enum class Register {
 constexpr int MAX_TEMP_REGS = 8;
 constexpr int MAX_VAR_REGS = 8;
 
-extern std::map<int, Register> tempToRegs;
-extern std::queue<Register> freeTempRegs;
+// use template to dynamically generate
+template<std::size_t... Indices>
+constexpr auto genCleanRegs(std::index_sequence<Indices...>, bool tempElseVar) {
+    return std::queue<Register>{{static_cast<Register>(Indices + static_cast<size_t>(tempElseVar ? Register::t0 : Register::s0))...}};
+}
 
-extern std::map<IR::Var, Register> varToRegs;
-extern std::queue<Register> freeVarRegs;
+template<std::size_t N>
+constexpr auto cleanRegQueue(bool tempElseVar) {
+    return genCleanRegs<>(std::make_index_sequence<N>{}, tempElseVar);
+}
+
+std::map<int, Register> &tempToRegs();
+std::queue<Register> &freeTempRegs();
+
+std::map<IR::Var, Register> &varToRegs();
+std::queue<Register> &freeVarRegs();
 
 Register newReg(const IR::Temp *temp);
 
@@ -81,9 +94,8 @@ Register getReg(const IR::Temp *temp);
 // if freeTempRegs is empty (reg==$t8), we should store temp on stack
 void checkTempReg(const IR::Temp *temp, Register reg);
 
-void clearRegs();
-
-std::string regToString(Register reg);
+// "$t0", "" for none
+std::string_view regName(Register reg);
 
 } // namespace MIPS
 
@@ -0,0 +1,48 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "config.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Output::Config Output::parse(const std::string &spec) {
+    Config config{None, None, None, None, None};
+    std::size_t begin = 0;
+    while (begin < spec.size()) {
+        auto end = std::min(spec.find(',', begin), spec.size());
+        auto entry = spec.substr(begin, end - begin);
+        begin = end + 1;
+        if (entry.empty()) {
+            continue;
+        }
+
+        auto colon = entry.find(':');
+        auto artifact = entry.substr(0, colon);
+        auto sinkName = colon == std::string::npos ? "file" : entry.substr(colon + 1);
+        Sink sink;
+        if (sinkName == "file") {
+            sink = File;
+        } else if (sinkName == "stdout") {
+            sink = Stdout;
+        } else {
+            throw std::invalid_argument("no output sink " + sinkName + ", there are: file stdout");
+        }
+
+        if (artifact == "lexer") {
+            config.lexer |= sink;
+        } else if (artifact == "parser") {
+            config.parser |= sink;
+        } else if (artifact == "error") {
+            config.error |= sink;
+        } else if (artifact == "ir") {
+            config.ir |= sink;
+        } else if (artifact == "mips") {
+            config.mips |= sink;
+        } else {
+            throw std::invalid_argument("no output " + artifact + ", there are: lexer parser error ir mips");
+        }
+    }
+    return config;
+}
@@ -5,20 +5,32 @@
 #ifndef COMPILER_CONFIG_H
 #define COMPILER_CONFIG_H
 
-#define FILEOUT_ERROR
-// #define FILEOUT_LEXER
-// #define FILEOUT_PARSER
-#define FILEOUT_MIPS
+#include <string>
 
+// Which artifacts a compilation writes, and where.
+// A disabled artifact costs nothing: its stream is never opened and its text never formatted.
+namespace Output {
+// bit set of where an artifact goes
+enum Sink : unsigned {
+    None = 0,
+    File = 1,   // the file given to compile()
+    Stdout = 2,
+};
 
-#if defined(MY_DEBUG)
-// #define STDOUT_LEXER
-// #define STDOUT_PARSER
-#define STDOUT_ERROR
-// #define STDOUT_IR
-#define FILEOUT_IR
-// #define STDOUT_MIPS
-#endif
+struct Config {
+    // both go to the outFile of compile()
+    unsigned lexer{None};
+    unsigned parser{None};
+    unsigned error{File};
+    unsigned ir{None};
+    unsigned mips{File};
+};
 
+// comma separated "<artifact>[:file|:stdout]" like "mips,ir,error:stdout", file by default,
+// an artifact may be given with both, the artifacts not given are disabled, "" disables all
+// artifacts: lexer parser error ir mips
+// throw std::invalid_argument on an unknown artifact or sink
+Config parse(const std::string &spec);
+} // namespace Output
 
 #endif
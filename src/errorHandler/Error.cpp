@@ -6,31 +6,36 @@
 
 #include <iostream>
 
-#include "config.h"
+#include "Context.h"
 
-bool Error::hasError = false;
-std::ofstream Error::errorFileStream;
+bool Error::hasError() {
+    return Context::cur().error.hasError;
+}
 
 void Error::raise(char code, int row) {
-    hasError = true;
-#ifdef STDOUT_ERROR
-    std::cout << row << " " << code << '\n';
-#endif
-#ifdef FILEOUT_ERROR
-    errorFileStream << row << " " << code << '\n';
-#endif
+    auto &s = Context::cur().error;
+    s.hasError = true;
+    auto sinks = Context::cur().output.error;
+    if (sinks & Output::Stdout) {
+        std::cout << row << " " << code << '\n';
+    }
+    if (sinks & Output::File) {
+        s.errorFileStream << row << " " << code << '\n';
+    }
 }
 
 // My error, which is not defined in course tasks.
 void Error::raise(const std::string &mes) {
-    hasError = true;
-#ifdef STDOUT_ERROR
-    std::cout << "error: " << mes << " "
-              << "---------------------------------------\n";
-#endif
-#ifdef FILEOUT_ERROR
-    errorFileStream << "error: " << mes << " "
-                    << "---------------------------------------\n";
-#endif
+    auto &s = Context::cur().error;
+    s.hasError = true;
+    auto sinks = Context::cur().output.error;
+    if (sinks & Output::Stdout) {
+        std::cout << "error: " << mes << " "
+                  << "---------------------------------------\n";
+    }
+    if (sinks & Output::File) {
+        s.errorFileStream << "error: " << mes << " "
+                          << "---------------------------------------\n";
+    }
     // exit(-1);
 }
@@ -11,11 +11,15 @@
 
 class Error {
 public:
-    static bool hasError;
+    // error state of one compilation, owned by Context
+    struct State {
+        bool hasError = false;
+        std::ofstream errorFileStream;
+    };
 
-    static std::ofstream errorFileStream;
+    static bool hasError();
 
-    static void raise(char code, int row = Lexer::curRow);
+    static void raise(char code, int row = Lexer::curRow());
 
     static void raise(const std::string &mes = "unnamed");
 };
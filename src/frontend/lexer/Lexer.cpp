@@ -5,66 +5,173 @@
 #include "Lexer.h"
 
 #include "config.h"
+#include "Context.h"
+#include "Scan.h"
 #include "errorHandler/Error.h"
 #include "tools/LinkedHashMap.h"
 
-#include <sstream>
+#include <iostream>
 #include <utility>
 
-std::ofstream Lexer::outFileStream;
-std::string Lexer::fileContents;
-
-Word words[Lexer::deep];
-LexType &Lexer::curLexType = words[0].first;
-Token &Lexer::curToken = words[0].second;
+namespace {
+Lexer::State &state() {
+    return Context::cur().lexer;
+}
+} // namespace
 
-int Lexer::pos[deep]; // count from 1
-int Lexer::column[deep]; // count from 1
-int Lexer::row[deep]; // count from 1.
-// ReSharper disable once CppRedundantQualifier
-int &Lexer::curRow = Lexer::row[0];
+std::ofstream &Lexer::outFileStream() {
+    return state().outFileStream;
+}
 
-char c; // c = fileContents[posTemp - 1]
-int posTemp;
-int columnTemp;
-int rowTemp{1};
+Word Lexer::peek(int n) {
+    return state().words[n];
+}
 
-// synchronize output of parser and lexer
-bool firstOutput = true;
-LexType lastLexType;
-Token lastToken;
+LexType Lexer::curLexType() {
+    return state().words[0].first;
+}
 
-LinkedHashMap<std::string, LexType> reserveWords;
+Token Lexer::curToken() {
+    return state().words[0].second;
+}
 
-Word Lexer::peek(int n) {
-    return words[n];
+int Lexer::curRow() {
+    return state().row[0];
 }
 
 // also return EOF
 char nextChar() {
-    if (posTemp >= Lexer::fileContents.size()) {
-        c = EOF;
+    auto &s = state();
+    if (s.posTemp >= s.fileContents.size()) {
+        s.c = EOF;
         return EOF;
     }
 
-    if (c == '\n') {
-        rowTemp++;
-        columnTemp = 1;
+    if (s.c == '\n') {
+        s.rowTemp++;
+        s.columnTemp = 1;
     } else {
-        columnTemp++;
+        s.columnTemp++;
     }
 
-    c = Lexer::fileContents[posTemp++];
+    s.c = s.fileContents[s.posTemp++];
+
+    return s.c;
+}
 
-    return c;
+// index of c in fileContents, also valid at EOF
+size_t curIndex() {
+    auto &s = state();
+    return s.c == EOF ? s.fileContents.size() : s.posTemp - 1;
 }
 
-void reserve(const Token &t, LexType &l) {
-    if (reserveWords.containsKey(t)) {
-        l = reserveWords.get(t);
+// move c forward to fileContents[to] (EOF if to is out of range).
+// rowTemp and columnTemp end up as if nextChar() was called one by one.
+void moveTo(size_t to) {
+    auto &s = state();
+    const auto &text = s.fileContents;
+    size_t from = curIndex();
+    if (from >= text.size()) {
+        return;
+    }
+
+    if (to >= text.size()) {
+        // EOF keeps the position of the last char
+        moveTo(text.size() - 1);
+        nextChar();
+        return;
+    }
+
+    size_t lines = Scan::countNewlines(text.data() + from, to - from);
+    if (lines == 0) {
+        s.columnTemp += static_cast<int>(to - from);
     } else {
-        l = LexType::IDENFR;
+        s.rowTemp += static_cast<int>(lines);
+        s.columnTemp = static_cast<int>(to - text.rfind('\n', to - 1));
+    }
+
+    s.posTemp = static_cast<int>(to) + 1;
+    s.c = text[to];
+}
+
+void skipSpace() {
+    moveTo(Scan::skipSpace(state().fileContents, curIndex()));
+}
+
+// perfect hash on (length, first char) of SysY keywords,
+// each pair has at most one candidate, so only one comparison is made
+constexpr LexType reserve(Token t) {
+    auto match = [t](Token word, LexType type) {
+        return t == word ? type : LexType::IDENFR;
+    };
+
+    switch (t.size()) {
+        case 2:
+            if (t[0] == 'i') return match("if", LexType::IFTK);
+            break;
+        case 3:
+            if (t[0] == 'i') return match("int", LexType::INTTK);
+            if (t[0] == 'f') return match("for", LexType::FORTK);
+            break;
+        case 4:
+            if (t[0] == 'm') return match("main", LexType::MAINTK);
+            if (t[0] == 'e') return match("else", LexType::ELSETK);
+            if (t[0] == 'v') return match("void", LexType::VOIDTK);
+            break;
+        case 5:
+            if (t[0] == 'c') return match("const", LexType::CONSTTK);
+            if (t[0] == 'b') return match("break", LexType::BREAKTK);
+            break;
+        case 6:
+            if (t[0] == 'g') return match("getint", LexType::GETINTTK);
+            if (t[0] == 'p') return match("printf", LexType::PRINTFTK);
+            if (t[0] == 'r') return match("return", LexType::RETURNTK);
+            break;
+        case 8:
+            if (t[0] == 'c') return match("continue", LexType::CONTINUETK);
+            break;
+        default:
+            break;
     }
+    return LexType::IDENFR;
+}
+
+static_assert(reserve("continue") == LexType::CONTINUETK);
+static_assert(reserve("int") == LexType::INTTK);
+static_assert(reserve("ifx") == LexType::IDENFR);
+static_assert(reserve("cons") == LexType::IDENFR);
+
+// operators, the longer one is put before its prefix ("<=" before "<")
+// built once and shared by all compilations
+const LinkedHashMap<std::string, LexType> &operators() {
+    static const auto operators = [] {
+        LinkedHashMap<std::string, LexType> operators;
+        operators.put("&&", LexType::AND);
+        operators.put("||", LexType::OR);
+        operators.put("+", LexType::PLUS);
+        operators.put("-", LexType::MINU);
+        operators.put("*", LexType::MULT);
+        operators.put("/", LexType::DIV);
+        operators.put("%", LexType::MOD);
+        operators.put("<=", LexType::LEQ);
+        operators.put("<", LexType::LSS);
+        operators.put(">=", LexType::GEQ);
+        operators.put(">", LexType::GRE);
+        operators.put("==", LexType::EQL);
+        operators.put("!=", LexType::NEQ);
+        operators.put("!", LexType::NOT);
+        operators.put("=", LexType::ASSIGN);
+        operators.put(";", LexType::SEMICN);
+        operators.put(",", LexType::COMMA);
+        operators.put("(", LexType::LPARENT);
+        operators.put(")", LexType::RPARENT);
+        operators.put("[", LexType::LBRACK);
+        operators.put("]", LexType::RBRACK);
+        operators.put("{", LexType::LBRACE);
+        operators.put("}", LexType::RBRACE);
+        return operators;
+    }();
+    return operators;
 }
 
 void output();
@@ -74,214 +181,149 @@ void updateWords(LexType l, Token t);
 // stop if you read LexType::Lex_END
 // or the file will be read in loop
 Word Lexer::next() {
+    auto &s = state();
+    const auto &fileContents = s.fileContents;
+
     // Ident
     // IntConst
     // FormatString
 
-    if (posTemp > fileContents.length()) {
-        updateWords(LexType::LEX_END, "");
-        output();
-        return words[0];
-    }
-
-    LexType lexType = LexType::LEX_EMPTY;
-    Token token = std::string(1, c);
-
-    if (c >= '0' && c <= '9') {
-        while (isdigit(nextChar())) {
-            token += c;
-        }
-        // error: bad number
-        lexType = LexType::INTCON;
-    } else if (c == '_' || isalpha(c)) {
-        while (nextChar(), c == '_' || isalpha(c) || isdigit(c)) {
-            token += c;
+    // comments are skipped in a loop, a long run of them must not grow the stack
+    LexType lexType;
+    Token token;
+    do {
+        if (s.c == EOF) {
+            updateWords(LexType::LEX_END, {});
+            output();
+            return s.words[0];
         }
-        reserve(token, lexType);
-    } else if (c == '/') {
-        // q1
-        nextChar();
-        if (c == '/') {
-            // q2
-            while (nextChar() != '\n') {}
-            // line comment //
-            token = "";
-            lexType = LexType::COMMENT;
-        } else if (c == '*') {
-            // q5
-        q5:
-            while (nextChar() != '*') {}
-            do {
-                if (c == '*') {
-                } else if (c == '/') {
-                    break; // q7
-                } else {
-                    goto q5;
-                }
-            } while (nextChar());
-            // block comment /**/
-            token = "";
-            lexType = LexType::COMMENT;
+
+        lexType = LexType::LEX_EMPTY;
+        size_t begin = curIndex();
+        token = fileContents.substr(begin, 1);
+
+        if (s.c >= '0' && s.c <= '9') {
+            moveTo(Scan::skipDigits(fileContents, begin + 1));
+            // error: bad number
+            lexType = LexType::INTCON;
+            token = fileContents.substr(begin, curIndex() - begin);
+        } else if (s.c == '_' || isalpha(s.c)) {
+            moveTo(Scan::skipIdent(fileContents, begin + 1));
+            token = fileContents.substr(begin, curIndex() - begin);
+            lexType = reserve(token);
+        } else if (s.c == '/') {
+            // q1
             nextChar();
+            if (s.c == '/') {
+                // q2, stop at '\n'
+                moveTo(fileContents.find('\n', begin + 2));
+                // line comment //
+                token = {};
+                lexType = LexType::COMMENT;
+            } else if (s.c == '*') {
+                // q5 ~ q7, "/*/" is not closed
+                size_t close = fileContents.find("*/", begin + 2);
+                moveTo(close == std::string_view::npos ? close : close + 2);
+                // block comment /**/
+                token = {};
+                lexType = LexType::COMMENT;
+            } else {
+                token = fileContents.substr(begin, 1); // q4
+                lexType = LexType::DIV;
+            }
+        } else if (s.c == '\"') {
+            // STRCON
+            // error: bad char in format string
+            size_t close = fileContents.find('\"', begin + 1);
+            moveTo(close == std::string_view::npos ? close : close + 1);
+
+            lexType = LexType::STRCON;
+            token = fileContents.substr(begin, curIndex() - begin);
         } else {
-            token = "/"; // q4
-            lexType = LexType::DIV;
-        }
-    } else if (c == '\"') {
-        // STRCON
-        while (nextChar() != EOF) {
-            token += c;
-            if (c == '\"') {
-                break;
-            } // error: bad char in format string
-        }
-
-        lexType = LexType::STRCON;
-        nextChar();
-    } else {
-        // special operator +-*/ && &
-        for (const auto &[str, type]: reserveWords) {
-            if (fileContents.substr(posTemp - 1, str.length()) == str) {
-                posTemp += static_cast<int>(str.length());
-                columnTemp += static_cast<int>(str.length());
-                c = fileContents[posTemp - 1];
-
-                token = str;
-                lexType = type;
-                break;
+            // special operator +-*/ && &
+            for (const auto &[str, type]: operators()) {
+                if (fileContents.compare(begin, str.length(), str) == 0) {
+                    moveTo(begin + str.length());
+
+                    token = fileContents.substr(begin, str.length());
+                    lexType = type;
+                    break;
+                }
             }
         }
-    }
 
-    if (lexType == LexType::COMMENT) {
-        while (isspace(c)) {
-            nextChar();
-        }
-        next();
-    } else {
-        updateWords(lexType, token);
-        output();
-        while (isspace(c)) {
-            nextChar();
+        if (lexType == LexType::COMMENT) {
+            skipSpace();
         }
-    }
+    } while (lexType == LexType::COMMENT);
 
-    return words[0];
-}
+    updateWords(lexType, token);
+    output();
+    skipSpace();
+    Stats::count(Stats::Counter::Tokens);
 
-void buildReserveWords() {
-    // IDENFR
-    // INTCON
-    // STRCON
-    reserveWords.put("main", LexType::MAINTK);
-    reserveWords.put("const", LexType::CONSTTK);
-    reserveWords.put("int", LexType::INTTK);
-    reserveWords.put("break", LexType::BREAKTK);
-    reserveWords.put("continue", LexType::CONTINUETK);
-    reserveWords.put("if", LexType::IFTK);
-    reserveWords.put("else", LexType::ELSETK);
-    reserveWords.put("&&", LexType::AND);
-    reserveWords.put("||", LexType::OR);
-    reserveWords.put("for", LexType::FORTK);
-    reserveWords.put("getint", LexType::GETINTTK);
-    reserveWords.put("printf", LexType::PRINTFTK);
-    reserveWords.put("return", LexType::RETURNTK);
-    reserveWords.put("+", LexType::PLUS);
-    reserveWords.put("-", LexType::MINU);
-    reserveWords.put("void", LexType::VOIDTK);
-    reserveWords.put("*", LexType::MULT);
-    reserveWords.put("/", LexType::DIV);
-    reserveWords.put("%", LexType::MOD);
-    reserveWords.put("<=", LexType::LEQ);
-    reserveWords.put("<", LexType::LSS);
-    reserveWords.put(">=", LexType::GEQ);
-    reserveWords.put(">", LexType::GRE);
-    reserveWords.put("==", LexType::EQL);
-    reserveWords.put("!=", LexType::NEQ);
-    reserveWords.put("!", LexType::NOT);
-    reserveWords.put("=", LexType::ASSIGN);
-    reserveWords.put(";", LexType::SEMICN);
-    reserveWords.put(",", LexType::COMMA);
-    reserveWords.put("(", LexType::LPARENT);
-    reserveWords.put(")", LexType::RPARENT);
-    reserveWords.put("[", LexType::LBRACK);
-    reserveWords.put("]", LexType::RBRACK);
-    reserveWords.put("{", LexType::LBRACE);
-    reserveWords.put("}", LexType::RBRACE);
+    return s.words[0];
 }
 
 void output() {
-    if (firstOutput) {
-        firstOutput = false;
-        lastLexType = Lexer::curLexType;
-        lastToken = Lexer::curToken;
+    auto &s = state();
+    if (s.firstOutput) {
+        s.firstOutput = false;
+        s.lastLexType = Lexer::curLexType();
+        s.lastToken = Lexer::curToken();
     } else {
-        if (!(lastLexType == LexType::LEX_EMPTY || lastLexType == LexType::LEX_END)) {
-#ifdef STDOUT_LEXER
-            std::cout << toString(lastLexType) << " " << lastToken
-                      << '\n';
-#endif
-#ifdef FILEOUT_LEXER
-            Lexer::outFileStream << toString(lastLexType) << " " << lastToken
-                                 << '\n';
-#endif
+        auto sinks = Context::cur().output.lexer;
+        if (sinks && !(s.lastLexType == LexType::LEX_EMPTY || s.lastLexType == LexType::LEX_END)) {
+            if (sinks & Output::Stdout) {
+                std::cout << toString(s.lastLexType) << " " << s.lastToken
+                          << '\n';
+            }
+            if (sinks & Output::File) {
+                s.outFileStream << toString(s.lastLexType) << " " << s.lastToken
+                                << '\n';
+            }
         }
 
-        lastLexType = Lexer::curLexType;
-        lastToken = Lexer::curToken;
+        s.lastLexType = Lexer::curLexType();
+        s.lastToken = Lexer::curToken();
     }
 }
 
 void updateWords(LexType l, Token t) {
-    using namespace Lexer;
+    using Lexer::deep;
+    auto &s = state();
     for (int i = 0; i < deep - 1; ++i) {
-        words[i] = words[i + 1];
-        pos[i] = pos[i + 1];
-        column[i] = column[i + 1];
-        row[i] = row[i + 1];
+        s.words[i] = s.words[i + 1];
+        s.pos[i] = s.pos[i + 1];
+        s.column[i] = s.column[i + 1];
+        s.row[i] = s.row[i + 1];
     }
 
-    pos[deep - 1] = posTemp;
-    column[deep - 1] = columnTemp;
-    row[deep - 1] = rowTemp;
-
-    words[deep - 1].first = l;
-    words[deep - 1].second = std::move(t);
-}
+    s.pos[deep - 1] = s.posTemp;
+    s.column[deep - 1] = s.columnTemp;
+    s.row[deep - 1] = s.rowTemp;
 
-// distinguish between Exp and LVal in Stmt
-// It's wrong if Cond is a kind of Exp, but our work doesn't require it.
-bool Lexer::findAssignBeforeSemicolon() {
-    for (int t = pos[0] - 1;
-         t < fileContents.length() && fileContents[t] != ';'; ++t) {
-        if (fileContents[t] == '=') {
-            return true;
-        }
-    }
-    return false;
+    s.words[deep - 1].first = l;
+    s.words[deep - 1].second = t;
 }
 
 void Lexer::init(const std::string &inFile, const std::string &outFile) {
-    buildReserveWords();
-
-    auto inFileStream = std::ifstream(inFile);
-    if (!inFileStream) {
-        throw std::runtime_error("Reading " + inFile + " fails!");
-    }
-
-#if defined(FILEOUT_LEXER) || defined(FILEOUT_PARSER)
-    outFileStream = std::ofstream(outFile);
-    if (!outFileStream && !outFile.empty()) {
-        throw std::runtime_error("Writing " + outFile + " fails!");
+    auto &s = state();
+    s.sourceFile = MappedFile(inFile);
+
+    auto &output = Context::cur().output;
+    if ((output.lexer | output.parser) & Output::File) {
+        s.outFileStream = std::ofstream(outFile);
+        if (!s.outFileStream && !outFile.empty()) {
+            throw std::runtime_error("Writing " + outFile + " fails!");
+        }
     }
-#endif
 
 
-    std::stringstream buffer;
-    buffer << inFileStream.rdbuf();
-    fileContents = buffer.str();
+    s.fileContents = s.sourceFile.view();
 
-    while (isspace(nextChar())) {}
+    nextChar();
+    skipSpace();
     for (int i = 0; i < deep; ++i) {
         next();
     }
@@ -7,44 +7,63 @@
 
 #include <fstream>
 #include <string>
+#include <string_view>
 
 #include "LexType.h"
+#include "tools/MappedFile.h"
 
-using Token = std::string;
+// view into the source file, valid while the Context of the compilation lives
+using Token = std::string_view;
 using Word = std::pair<LexType, Token>;
 
 // commented var and func are private
 namespace Lexer {
-void init(const std::string &inFile, const std::string &outFile);
-
-extern std::ofstream outFileStream;
-extern std::string fileContents;
-
 // pre-reading deep.
 static constexpr size_t deep = 3;
 
-// char c;            // c = fileContents[posTemp - 1]
-extern int pos[deep]; // count from 1
-extern int column[deep]; // count from 1
-extern int row[deep]; // count from 1
-extern int &curRow; // row[0]
+// lexer state of one compilation, owned by Context
+struct State {
+    std::ofstream outFileStream;
+
+    // owns the mapping behind fileContents and every Token
+    MappedFile sourceFile;
+    // read-only view of the memory-mapped source file
+    std::string_view fileContents;
+
+    Word words[deep];
+    int pos[deep]{}; // count from 1
+    int column[deep]{}; // count from 1
+    int row[deep]{}; // count from 1
+
+    char c{}; // c = fileContents[posTemp - 1]
+    int posTemp{};
+    int columnTemp{};
+    int rowTemp{1};
+
+    // synchronize output of parser and lexer
+    bool firstOutput{true};
+    LexType lastLexType{};
+    Token lastToken;
+};
+
+void init(const std::string &inFile, const std::string &outFile);
+
+std::ofstream &outFileStream();
 
 Word peek(int n = 0);
 
-// Word words[deep];
-extern LexType &curLexType;
-extern Token &curToken;
+// words[0]
+LexType curLexType();
+Token curToken();
+int curRow(); // row[0]
 
-// LinkedHashMap<std::string, LexType> buildReserveWords();
-// LinkedHashMap<std::string, LexType> reserveWords;
+// const LinkedHashMap<std::string, LexType> &operators();
 // char nextChar();
-// void reserve(const Token &t, LexType &l);
+// constexpr LexType reserve(Token t);
 // void output();
 // void updateWords(LexType l, Token t);
 
 Word next();
-
-bool findAssignBeforeSemicolon();
 } // namespace Lexer
 
 #endif
@@ -0,0 +1,165 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Scan.h"
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_SIMD
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCAN_SIMD
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isIdent(char c) {
+    return c == '_' || isDigit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+#ifdef SCAN_SIMD
+int countTrailingZeros(std::uint32_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return static_cast<int>(i);
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+int popCount(std::uint32_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<int>(__popcnt(x));
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+// one vector register of bytes
+// all compares are signed, bytes >= 0x80 are negative and never match an ASCII class
+#if defined(__AVX2__)
+struct Simd {
+    using V = __m256i;
+    static constexpr std::size_t width = 32;
+    static constexpr std::uint32_t all = 0xFFFF'FFFF;
+
+    static V load(const char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static V set(char c) { return _mm256_set1_epi8(c); }
+    static V eq(V a, V b) { return _mm256_cmpeq_epi8(a, b); }
+    static V gt(V a, V b) { return _mm256_cmpgt_epi8(a, b); }
+    static V and_(V a, V b) { return _mm256_and_si256(a, b); }
+    static V or_(V a, V b) { return _mm256_or_si256(a, b); }
+    static std::uint32_t mask(V v) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(v)); }
+};
+#else
+struct Simd {
+    using V = __m128i;
+    static constexpr std::size_t width = 16;
+    static constexpr std::uint32_t all = 0xFFFF;
+
+    static V load(const char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    static V set(char c) { return _mm_set1_epi8(c); }
+    static V eq(V a, V b) { return _mm_cmpeq_epi8(a, b); }
+    static V gt(V a, V b) { return _mm_cmpgt_epi8(a, b); }
+    static V and_(V a, V b) { return _mm_and_si128(a, b); }
+    static V or_(V a, V b) { return _mm_or_si128(a, b); }
+    static std::uint32_t mask(V v) { return static_cast<std::uint32_t>(_mm_movemask_epi8(v)); }
+};
+#endif
+
+// lo <= v <= hi
+Simd::V inRange(Simd::V v, char lo, char hi) {
+    return Simd::and_(Simd::gt(v, Simd::set(static_cast<char>(lo - 1))),
+                      Simd::gt(Simd::set(static_cast<char>(hi + 1)), v));
+}
+
+Simd::V spaceMask(Simd::V v) {
+    return Simd::or_(Simd::eq(v, Simd::set(' ')), inRange(v, '\t', '\r'));
+}
+
+Simd::V digitMask(Simd::V v) {
+    return inRange(v, '0', '9');
+}
+
+Simd::V identMask(Simd::V v) {
+    // 'A'-'Z' | 0x20 is 'a'-'z', no other byte is folded into 'a'-'z'
+    auto lower = Simd::or_(v, Simd::set(0x20));
+    return Simd::or_(Simd::or_(inRange(lower, 'a', 'z'), digitMask(v)),
+                     Simd::eq(v, Simd::set('_')));
+}
+#endif
+
+template<class VecPred, class Pred>
+std::size_t skipWhile(std::string_view s, std::size_t i, VecPred vecPred, Pred pred) {
+#ifdef SCAN_SIMD
+    for (; i + Simd::width <= s.size(); i += Simd::width) {
+        std::uint32_t m = Simd::mask(vecPred(Simd::load(s.data() + i)));
+        if (m != Simd::all) {
+            return i + countTrailingZeros(~m & Simd::all);
+        }
+    }
+#endif
+    while (i < s.size() && pred(s[i])) {
+        ++i;
+    }
+    return i;
+}
+} // namespace
+
+std::size_t Scan::skipSpace(std::string_view s, std::size_t i) {
+#ifdef SCAN_SIMD
+    // most runs are a single ' ' between tokens
+    if (i < s.size() && !isSpace(s[i])) {
+        return i;
+    }
+    return skipWhile(s, i, spaceMask, isSpace);
+#else
+    return skipWhile(s, i, nullptr, isSpace);
+#endif
+}
+
+std::size_t Scan::skipIdent(std::string_view s, std::size_t i) {
+#ifdef SCAN_SIMD
+    return skipWhile(s, i, identMask, isIdent);
+#else
+    return skipWhile(s, i, nullptr, isIdent);
+#endif
+}
+
+std::size_t Scan::skipDigits(std::string_view s, std::size_t i) {
+#ifdef SCAN_SIMD
+    return skipWhile(s, i, digitMask, isDigit);
+#else
+    return skipWhile(s, i, nullptr, isDigit);
+#endif
+}
+
+std::size_t Scan::countNewlines(const char *p, std::size_t n) {
+    std::size_t count = 0;
+    std::size_t i = 0;
+#ifdef SCAN_SIMD
+    auto newline = Simd::set('\n');
+    for (; i + Simd::width <= n; i += Simd::width) {
+        count += popCount(Simd::mask(Simd::eq(Simd::load(p + i), newline)));
+    }
+#endif
+    for (; i < n; ++i) {
+        count += p[i] == '\n';
+    }
+    return count;
+}
@@ -0,0 +1,28 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_SCAN_H
+#define COMPILER_SCAN_H
+
+#include <cstddef>
+#include <string_view>
+
+// Bulk scanning of source text for Lexer.
+// Use SSE2 (AVX2 if the compiler targets it), or scalar loops on other targets.
+// Never read past the end of the view: the source is memory-mapped.
+namespace Scan {
+// return the first index >= i whose char is not whitespace (same set as isspace)
+std::size_t skipSpace(std::string_view s, std::size_t i);
+
+// return the first index >= i whose char is not in [A-Za-z0-9_]
+std::size_t skipIdent(std::string_view s, std::size_t i);
+
+// return the first index >= i whose char is not in [0-9]
+std::size_t skipDigits(std::string_view s, std::size_t i);
+
+// number of '\n' in [p, p + n)
+std::size_t countNewlines(const char *p, std::size_t n);
+} // namespace Scan
+
+#endif
@@ -5,11 +5,15 @@
 #include "Parser.h"
 
 #include "config.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
+#include "tools/Stats.h"
+
+#include <iostream>
 
 
 void Parser::singleLex(LexType type, int row) {
-    if (Lexer::curLexType == type) {
+    if (Lexer::curLexType() == type) {
         Lexer::next();
     } else {
         if (type == LexType::SEMICN) {
@@ -25,10 +29,12 @@ void Parser::singleLex(LexType type, int row) {
 }
 
 void Parser::output(AST type) {
-#ifdef STDOUT_PARSER
-    std::cout << "<" << toString(type) << ">" << '\n';
-#endif
-#ifdef FILEOUT_PARSER
-    Lexer::outFileStream << "<" << toString(type) << ">" << '\n';
-#endif
+    Stats::count(Stats::Counter::AstNodes);
+    auto sinks = Context::cur().output.parser;
+    if (sinks & Output::Stdout) {
+        std::cout << "<" << toString(type) << ">" << '\n';
+    }
+    if (sinks & Output::File) {
+        Lexer::outFileStream() << "<" << toString(type) << ">" << '\n';
+    }
 }
@@ -11,7 +11,7 @@
 // Specific parser method is distributed in respective class.
 namespace Parser {
 // check the type and Lexer::next()
-void singleLex(LexType type, int row = Lexer::curRow);
+void singleLex(LexType type, int row = Lexer::curRow());
 
 void output(AST type);
 } // namespace Parser
@@ -3,23 +3,36 @@
 //
 
 #include "SymTab.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
 
-SymTab SymTab::global{nullptr};
+namespace {
+SymTab::State &state() {
+    return Context::cur().symTab;
+}
+} // namespace
+
+SymTab *&SymTab::cur() {
+    return state().cur;
+}
 
-SymTab *SymTab::cur = &global;
+SymTab &SymTab::global() {
+    return state().global;
+}
 
-std::vector<std::set<std::pair<std::string, int>>> SymTab::knownVars;
+std::vector<std::set<std::pair<std::string, int>>> &SymTab::knownVars() {
+    return state().knownVars;
+}
 
 bool SymTab::reDefine(const std::string &ident) {
-    if (cur->symbols.find(ident) != cur->symbols.end()) {
+    if (cur()->symbols.find(ident) != cur()->symbols.end()) {
         return true;
     }
     return false;
 }
 
 Symbol *SymTab::find(const std::string &ident) {
-    for (auto p = cur; p != nullptr; p = p->prev) {
+    for (auto p = cur(); p != nullptr; p = p->prev) {
         auto it = p->symbols.find(ident);
         if (it != p->symbols.end()) {
             return &it->second;
@@ -29,9 +42,9 @@ Symbol *SymTab::find(const std::string &ident) {
 }
 
 std::pair<Symbol *, int> SymTab::findInGen(const std::string &ident) {
-    auto knownVars_i = knownVars.crbegin();
-    for (SymTab *p = cur;
-         p != nullptr && knownVars_i != knownVars.crend();
+    auto knownVars_i = knownVars().crbegin();
+    for (SymTab *p = cur();
+         p != nullptr && knownVars_i != knownVars().crend();
          p = p->prev, ++knownVars_i) {
         auto it = p->symbols.find(ident);
         if (it != p->symbols.end() && (it->second.symType == SymType::Param || knownVars_i->find({ident, p->depth}) != knownVars_i->end())) {
@@ -42,7 +55,7 @@ std::pair<Symbol *, int> SymTab::findInGen(const std::string &ident) {
 }
 
 int SymTab::findDepth(const std::string &ident) {
-    for (auto symTab = cur; symTab != nullptr; symTab = symTab->prev) {
+    for (auto symTab = cur(); symTab != nullptr; symTab = symTab->prev) {
         auto it = symTab->symbols.find(ident);
         if (it != symTab->symbols.end()) {
             return symTab->depth;
@@ -55,17 +68,14 @@ void SymTab::add(const std::string &ident, Symbol &&symbol, SymTab *where) {
     where->symbols.emplace(ident, std::move(symbol));
 }
 
-
-std::list<SymTab *> SymTab::symTabs;
-
 void SymTab::deepIn() {
-    auto &newSymTab = cur->next.emplace_back(std::make_unique<SymTab>(cur));
-    cur = newSymTab.get();
-    symTabs.push_back(cur);
+    auto &newSymTab = cur()->next.emplace_back(std::make_unique<SymTab>(cur()));
+    cur() = newSymTab.get();
+    state().symTabs.push_back(cur());
 }
 
 void SymTab::deepOut() {
-    cur = cur->prev;
+    cur() = cur()->prev;
 }
 
 SymTab *SymTab::getPrev() const {
@@ -81,14 +91,29 @@ void SymTab::iterIn() {
     /*static std::queue<SymTab *> iterIndex = global.dfs();
     cur = iterIndex.front();
     iterIndex.pop();*/
-    cur = symTabs.front();
-    symTabs.pop_front();
-    SymTab::knownVars.emplace_back();
+    cur() = state().symTabs.front();
+    state().symTabs.pop_front();
+    SymTab::knownVars().emplace_back();
 }
 
 void SymTab::iterOut() {
-    cur = cur->prev;
-    SymTab::knownVars.pop_back();
+    cur() = cur()->prev;
+    SymTab::knownVars().pop_back();
+}
+
+void SymTab::releaseScopes() {
+    if (!global().next.empty()) {
+        auto &funcSymTab = global().next.back();
+        funcSymTab->next.clear();
+        for (auto it = funcSymTab->symbols.begin(); it != funcSymTab->symbols.end();) {
+            if (it->second.symType == SymType::Param) {
+                ++it;
+            } else {
+                it = funcSymTab->symbols.erase(it);
+            }
+        }
+    }
+    state().symTabs.clear();
 }
 
 int SymTab::getDepth() const {
@@ -26,13 +26,13 @@ class SymTab {
 
     int depth;
 
-    static std::list<SymTab *> symTabs;
-
 public:
-    static SymTab *cur;
-    static SymTab global;
+    struct State;
+
+    static SymTab *&cur();
+    static SymTab &global();
 
-    static std::vector<std::set<std::pair<std::string, int>>> knownVars;
+    static std::vector<std::set<std::pair<std::string, int>>> &knownVars();
 
     explicit SymTab(SymTab *prev);
 
@@ -46,7 +46,7 @@ public:
     static int findDepth(const std::string &ident);
 
     // no effect if reDefine(ident)
-    static void add(const std::string &ident, Symbol &&symbol, SymTab *where = cur);
+    static void add(const std::string &ident, Symbol &&symbol, SymTab *where = cur());
 
     // create a new empty SymTab, and set cur to the new one
     static void deepIn();
@@ -59,10 +59,26 @@ public:
     static void iterIn();
     static void iterOut();
 
+    // free the local symbols of the last function, its SymTabs must have been visited by iterIn()
+    // params stay, function Symbols in global point to them
+    // keeps memory bounded when functions are compiled one by one, see CompUnit::stream
+    static void releaseScopes();
+
     int getDepth() const;
 
     // std::queue<SymTab *> dfs();
 };
 
+// symbol tables of one compilation, owned by Context
+struct SymTab::State {
+    SymTab global{nullptr};
+    SymTab *cur{&global};
+
+    std::vector<std::set<std::pair<std::string, int>>> knownVars;
+
+    // in order of deepIn(), consumed by iterIn()
+    std::list<SymTab *> symTabs;
+};
+
 
 #endif
@@ -1,30 +1,266 @@
-#include "AST/CompUnit.h"
-#include "backend/MIPS.h"
-#include "errorHandler/Error.h"
-
-void compile(const std::string &inFile,
-             const std::string &outFile,
-             const std::string &errorFile,
-             const std::string &IRFile,
-             const std::string &mipsFile) {
-    Lexer::init(inFile, outFile);
-    Error::errorFileStream = std::ofstream(errorFile);
-    IR::IRFileStream = std::ofstream(IRFile);
-    MIPS::mipsFileStream = std::ofstream(mipsFile);
-
-    auto compUnit = CompUnit::parse();
-    if (!Error::hasError) {
-        auto module = compUnit->genIR();
-        module->outputIR();
-        MIPS::genMIPS(*module);
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "middle/PassManager.h"
+#include "middle/Profile.h"
+#include "tools/Bench.h"
+#include "tools/Check.h"
+#include "tools/Driver.h"
+#include "tools/Generator.h"
+#include "tools/Interpret.h"
+#include "tools/Simulate.h"
+#include "tools/Stats.h"
+#include "tools/ThreadPool.h"
+#include "tools/Throughput.h"
+
+namespace {
+// <file> [--input <file>] [--weights <file>] [--max-steps <n>] after args[0]
+// [--use-profile <file>] too if compiling
+Simulate::Config readSimOptions(const std::vector<std::string> &args, bool compiling) {
+    Simulate::Config options;
+    for (std::size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--input" && i + 1 < args.size()) {
+            options.inputFile = args[++i];
+        } else if (args[i] == "--weights" && i + 1 < args.size()) {
+            options.sim.weights = Sim::Weights::read(args[++i]);
+        } else if (args[i] == "--max-steps" && i + 1 < args.size()) {
+            options.sim.maxSteps = std::stoll(args[++i]);
+        } else if (compiling && args[i] == "--use-profile" && i + 1 < args.size()) {
+            options.useProfile = args[++i];
+        } else if (args[i][0] != '-' && options.file.empty()) {
+            options.file = args[i];
+        } else {
+            throw std::invalid_argument("bad argument " + args[i]);
+        }
+    }
+    if (options.file.empty()) {
+        throw std::invalid_argument("no input file");
+    }
+    return options;
+}
+
+// [<benchDir>] [--out <dir>] [--weights <file>] [--max-steps <n>] [--passes <spec>]... [--generate <n>]
+// [<generator option> <n>]... after args[0]
+Bench::Config readBenchOptions(const std::vector<std::string> &args, const std::string &outDir) {
+    Bench::Config options;
+    options.outDir = outDir;
+    // a miscompiled loop must not hang the whole run
+    options.sim.maxSteps = 500'000'000;
+    for (std::size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--out" && i + 1 < args.size()) {
+            options.outDir = args[++i];
+            if (options.outDir.back() != '/' && options.outDir.back() != '\\') {
+                options.outDir += '/';
+            }
+        } else if (args[i] == "--weights" && i + 1 < args.size()) {
+            options.sim.weights = Sim::Weights::read(args[++i]);
+        } else if (args[i] == "--max-steps" && i + 1 < args.size()) {
+            options.sim.maxSteps = std::stoll(args[++i]);
+        } else if (args[i] == "--passes" && i + 1 < args.size()) {
+            Opt::parse(args[i + 1]); // an unknown name fails here, not after the first programs
+            options.passes.push_back(args[++i]);
+        } else if (args[i] == "--generate" && i + 1 < args.size()) {
+            options.generated = std::stoi(args[++i]);
+        } else if (i + 1 < args.size() && Generator::set(options.generator, args[i], args[i + 1])) {
+            ++i;
+        } else if (args[i][0] != '-' && options.dir.empty()) {
+            options.dir = args[i];
+        } else {
+            throw std::invalid_argument("bad argument " + args[i]);
+        }
+    }
+    if (options.dir.empty() && options.generated <= 0) {
+        throw std::invalid_argument("no bench directory");
+    }
+    return options;
+}
+
+// [--lines <n>]... [--out <dir>] [<generator option> <n>]... after args[0]
+int throughput(const std::vector<std::string> &args) {
+    Throughput::Config config;
+    std::vector<std::size_t> lines;
+    for (std::size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--lines" && i + 1 < args.size()) {
+            lines.push_back(std::stoul(args[++i]));
+        } else if (args[i] == "--full") {
+            lines.insert(lines.end(), Throughput::FULL_LINES.begin(), Throughput::FULL_LINES.end());
+        } else if (i + 1 < args.size() && Generator::set(config.generator, args[i], args[i + 1])) {
+            ++i;
+        } else if (args[i] == "--out" && i + 1 < args.size()) {
+            config.dir = args[++i];
+            if (config.dir.back() != '/' && config.dir.back() != '\\') {
+                config.dir += '/';
+            }
+        } else {
+            throw std::invalid_argument("bad argument " + args[i]);
+        }
+    }
+    if (!lines.empty()) {
+        config.lines = lines;
+    }
+    Throughput::run(std::cout, config);
+    return EXIT_SUCCESS;
+}
+
+// [<generator option> <n>]... after args[0], the program goes to stdout
+int generate(const std::vector<std::string> &args) {
+    Generator::Config config;
+    for (std::size_t i = 1; i < args.size(); ++i) {
+        if (i + 1 < args.size() && Generator::set(config, args[i], args[i + 1])) {
+            ++i;
+        } else {
+            throw std::invalid_argument("bad argument " + args[i]);
+        }
     }
+    std::cout << Generator::generate(config);
+    return EXIT_SUCCESS;
 }
 
+void usage() {
+    std::string passes;
+    for (auto phase: {Opt::Phase::GenIR, Opt::Phase::IR, Opt::Phase::MIPS}) {
+        for (auto &pass: Opt::passNames(phase)) {
+            passes += " " + pass;
+        }
+    }
+    std::cerr << "usage: Compiler\n"
+                 "       Compiler <inFile> <outFile> <errorFile> <IRFile> <mipsFile>\n"
+                 "       Compiler [-j <threads>] [--stream] [--time-report[=json]] [--trace <file>] [--use-profile <file>]\n"
+                 "                [-O<level>] [--passes <spec>] [--enable <pass>] [--disable <pass>] [--emit <outputs>]\n"
+                 "                --batch <manifest>\n"
+                 "       Compiler [-j <threads>] [--stream] [--time-report[=json]] [--trace <file>] [--use-profile <file>]\n"
+                 "                [-O<level>] [--passes <spec>] [--enable <pass>] [--disable <pass>] [--emit <outputs>]\n"
+                 "                <inFile>...\n"
+                 "       Compiler --sim <mipsFile> [--input <file>] [--weights <file>] [--max-steps <n>]\n"
+                 "       Compiler --profile <inFile> [--input <file>] [--weights <file>] [--max-steps <n>] [--use-profile <file>]\n"
+                 "       Compiler --interp <inFile> [--input <file>] [--max-steps <n>]\n"
+                 "       Compiler --bench [<benchDir>] [--out <dir>] [--weights <file>] [--max-steps <n>] [--passes <spec>]...\n"
+                 "                        [--generate <n>] [<generator option> <n>]...\n"
+                 "       Compiler --check [<benchDir>] [--out <dir>] [--max-steps <n>] [--passes <spec>]...\n"
+                 "                        [--generate <n>] [<generator option> <n>]...\n"
+                 "       Compiler --throughput [--lines <n>]... [--full] [--out <dir>] [<generator option> <n>]...\n"
+                 "       Compiler --generate [<generator option> <n>]...\n"
+                 "generator options: --seed --functions --globals --array-dims --nesting-depth --loop-depth\n"
+                 "                   --expression-depth --statements --lines\n"
+                 "levels: -O0 to -O" + std::to_string(Opt::MAX_LEVEL) + ", -O" + std::to_string(Opt::DEFAULT_LEVEL) + " by default\n"
+                 "passes:" + passes + "\n"
+                 "spec: passes separated by ',', run in the given order within their phase\n"
+                 "outputs: <output>[:file|:stdout] separated by ',', \"error,mips\" by default\n"
+                 "         lexer parser (output.txt) error (error.txt) ir (ir.txt) mips (mips.txt)\n";
+}
+} // namespace
+
 int main(int argc, char *argv[]) {
-    if (argc == 5) {
-        compile(argv[1], argv[2], argv[3], argv[4], argv[5]);
-    } else {
-        compile("testfile.txt", "", "error.txt", "ir.txt", "mips.txt");
+    if (argc == 1) {
+        ThreadPool pool;
+        Driver::compile("testfile.txt", "output.txt", "error.txt", "ir.txt", "mips.txt", pool);
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() == 5 && args[0][0] != '-') {
+        ThreadPool pool;
+        Driver::compile(args[0], args[1], args[2], args[3], args[4], pool);
+        return EXIT_SUCCESS;
+    }
+
+    if (args[0] == "--sim" || args[0] == "--profile" || args[0] == "--interp" || args[0] == "--bench"
+        || args[0] == "--check" || args[0] == "--throughput" || args[0] == "--generate") {
+        try {
+            if (args[0] == "--interp") {
+                auto options = readSimOptions(args, false);
+                return Interpret::run({options.file, options.inputFile, options.sim.maxSteps});
+            }
+            if (args[0] == "--bench") {
+                return Bench::run(readBenchOptions(args, "bench_out/"));
+            }
+            if (args[0] == "--check") {
+                return Check::run(readBenchOptions(args, "check_out/"));
+            }
+            if (args[0] == "--throughput") {
+                return throughput(args);
+            }
+            if (args[0] == "--generate") {
+                return generate(args);
+            }
+            auto options = readSimOptions(args, args[0] == "--profile");
+            return args[0] == "--sim" ? Simulate::simulate(options) : Simulate::profile(options);
+        } catch (const std::invalid_argument &e) {
+            std::cerr << e.what() << '\n';
+            usage();
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+        }
+        return EXIT_FAILURE;
+    }
+
+    // batch mode
+    unsigned threads = 0;
+    Driver::Options options;
+    auto optimize = Opt::level(Opt::DEFAULT_LEVEL);
+    options.optimize = &optimize;
+    Profile::Frequencies frequencies;
+    std::string traceFile;
+    std::vector<Driver::Job> jobs;
+    try {
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            if (args[i] == "-j" && i + 1 < args.size()) {
+                threads = static_cast<unsigned>(std::stoul(args[++i]));
+            } else if (args[i] == "--stream") {
+                options.stream = true;
+            } else if (args[i] == "--time-report") {
+                options.report = Stats::Format::Table;
+            } else if (args[i] == "--time-report=json") {
+                options.report = Stats::Format::Json;
+            } else if (args[i] == "--trace" && i + 1 < args.size()) {
+                traceFile = args[++i];
+            } else if (args[i] == "--use-profile" && i + 1 < args.size()) {
+                frequencies = Profile::Frequencies::read(args[++i]);
+                options.profile = &frequencies;
+            } else if (args[i].rfind("-O", 0) == 0) {
+                optimize = Opt::level(std::stoi(args[i].substr(2)));
+            } else if (args[i] == "--passes" && i + 1 < args.size()) {
+                optimize = Opt::parse(args[++i]);
+            } else if ((args[i] == "--enable" || args[i] == "--disable") && i + 1 < args.size()) {
+                Opt::enable(optimize, args[i + 1], args[i] == "--enable");
+                ++i;
+            } else if (args[i] == "--emit" && i + 1 < args.size()) {
+                options.output = Output::parse(args[++i]);
+            } else if (args[i] == "--batch" && i + 1 < args.size()) {
+                auto manifestJobs = Driver::readManifest(args[++i]);
+                jobs.insert(jobs.end(), manifestJobs.begin(), manifestJobs.end());
+            } else if (args[i][0] == '-') {
+                usage();
+                return EXIT_FAILURE;
+            } else {
+                jobs.push_back({args[i], Driver::dirOf(args[i])});
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    // the reports show the allocations of each phase, see Stats::ALLOCATIONS_COUNTED
+    Stats::countAllocations(options.report != Stats::Format::None || !traceFile.empty());
+
+    if (traceFile.empty()) {
+        return Driver::compileAll(jobs, threads, options);
+    }
+
+    Stats::Trace trace;
+    options.trace = &trace;
+    auto res = Driver::compileAll(jobs, threads, options);
+    std::ofstream traceStream(traceFile);
+    trace.write(traceStream);
+    if (!traceStream) {
+        std::cerr << "Writing " + traceFile + " fails!\n";
+        return EXIT_FAILURE;
     }
-    return 0;
+    return res;
 }
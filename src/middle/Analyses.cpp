@@ -0,0 +1,80 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Analyses.h"
+
+#include <unordered_set>
+
+#include "tools/Stats.h"
+
+using namespace Opt;
+
+FunctionAnalyses::FunctionAnalyses(const IR::Function &func) :
+    func(&func) {}
+
+const BlockIndex &FunctionAnalyses::blockIndex() {
+    if (!blocks) {
+        Stats::Timer timer("analysis.blockIndex", func->getName());
+        blocks.emplace();
+        auto &basicBlocks = func->getBasicBlocks();
+        for (std::size_t i = 0; i < basicBlocks.size(); ++i) {
+            blocks->emplace(basicBlocks[i]->label.nameAndId, i);
+        }
+    }
+    return *blocks;
+}
+
+void FunctionAnalyses::invalidate(const Preserves &preserves) {
+    if (!preserves.blockIndex) {
+        blocks.reset();
+    }
+}
+
+ModuleAnalyses::ModuleAnalyses(const IR::Module &module) :
+    module(&module) {}
+
+const CallGraph &ModuleAnalyses::callGraph() {
+    if (!calls) {
+        Stats::Timer timer("analysis.callGraph");
+        calls.emplace();
+        auto add = [&](const IR::Function &func) {
+            auto &callees = (*calls)[func.getName()];
+            for (auto &block: func.getBasicBlocks()) {
+                for (auto &inst: block->instructions) {
+                    if (inst.op == IR::Op::Call) {
+                        callees.push_back(dynamic_cast<IR::Label *>(inst.arg1.get())->nameAndId);
+                    }
+                }
+            }
+        };
+        add(module->getMainFunction());
+        for (auto &func: module->getFunctions()) {
+            add(*func);
+        }
+    }
+    return *calls;
+}
+
+FunctionAnalyses &ModuleAnalyses::of(const IR::Function &func) {
+    return functions.try_emplace(&func, func).first->second;
+}
+
+void ModuleAnalyses::invalidate(const Preserves &preserves) {
+    if (!preserves.callGraph) {
+        calls.reset();
+    }
+
+    std::unordered_set<const IR::Function *> alive{&module->getMainFunction()};
+    for (auto &func: module->getFunctions()) {
+        alive.insert(func.get());
+    }
+    for (auto it = functions.begin(); it != functions.end();) {
+        if (alive.count(it->first)) {
+            it->second.invalidate(preserves);
+            ++it;
+        } else {
+            it = functions.erase(it);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_ANALYSES_H
+#define COMPILER_ANALYSES_H
+
+#include "IR.h"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Facts about the IR that passes ask for, computed on first use and cached by Opt::Pipeline
+// until a pass that does not preserve them runs.
+namespace Opt {
+// index in Function::getBasicBlocks() of the BasicBlock of each label
+using BlockIndex = std::unordered_map<std::string, std::size_t>;
+
+// names of the functions each function calls, main included
+using CallGraph = std::unordered_map<std::string, std::vector<std::string>>;
+
+// the analyses a pass keeps valid, the others are dropped after it runs
+struct Preserves {
+    bool blockIndex{};
+    bool callGraph{};
+
+    static Preserves all() {
+        return {true, true};
+    }
+};
+
+// analyses of one Function, only used by the thread running passes on it
+class FunctionAnalyses {
+public:
+    explicit FunctionAnalyses(const IR::Function &func);
+
+    const BlockIndex &blockIndex();
+
+    void invalidate(const Preserves &preserves);
+
+private:
+    const IR::Function *func;
+    std::optional<BlockIndex> blocks;
+};
+
+// analyses of a Module, with those of each of its functions
+// a module pass that adds functions must not preserve function analyses, a new Function may reuse a freed address
+class ModuleAnalyses {
+public:
+    explicit ModuleAnalyses(const IR::Module &module);
+
+    const CallGraph &callGraph();
+
+    // made on first use, so call it before running passes on several functions in parallel
+    FunctionAnalyses &of(const IR::Function &func);
+
+    // also drops the analyses of functions no longer in the module
+    void invalidate(const Preserves &preserves);
+
+private:
+    const IR::Module *module;
+    std::optional<CallGraph> calls;
+    std::unordered_map<const IR::Function *, FunctionAnalyses> functions;
+};
+} // namespace Opt
+
+#endif
@@ -6,13 +6,27 @@
 #include <utility>
 
 #include "config.h"
+#include "Context.h"
 #include "errorHandler/Error.h"
 
 
 using namespace IR;
 
-std::ofstream IR::IRFileStream;
-std::vector<std::string> Str::MIPS_strings;
+std::ofstream &IR::IRFileStream() {
+    return Context::cur().ir.IRFileStream;
+}
+
+int &IR::curRow() {
+    return Context::cur().ir.curRow;
+}
+
+std::vector<std::string> &Str::MIPS_strings() {
+    return Context::cur().ir.MIPS_strings;
+}
+
+std::vector<std::vector<int>> &ArrayData::MIPS_arrays() {
+    return Context::cur().ir.MIPS_arrays;
+}
 
 Module::Module(std::string name) :
     name(std::move(name)) {}
@@ -21,6 +35,10 @@ const std::vector<std::unique_ptr<Function>> &Module::getFunctions() const {
     return functions;
 }
 
+std::vector<std::unique_ptr<Function>> &Module::getFunctions() {
+    return functions;
+}
+
 Inst::Inst(Op op,
            std::unique_ptr<Element> res,
            std::unique_ptr<Element> arg1,
@@ -35,21 +53,21 @@ void Inst::outputIR() const {
     if (op == Op::Empty) {
         return;
     }
-#if defined(STDOUT_IR)
-    cout << opToStr(op) << '\t'
-         << (res ? res->toString() : "_") << '\t'
-         << (arg1 ? arg1->toString() : "_") << '\t'
-         << (arg2 ? arg2->toString() : "_") << '\t'
-         << '\n';
-#endif
-
-#if defined(FILEOUT_IR)
-    IRFileStream << opToStr(op) << '\t'
-                 << (res ? res->toString() : "_") << '\t'
-                 << (arg1 ? arg1->toString() : "_") << '\t'
-                 << (arg2 ? arg2->toString() : "_") << '\t'
-                 << '\n';
-#endif
+    auto sinks = Context::cur().output.ir;
+    if (!sinks) {
+        return;
+    }
+    auto line = opToStr(op) + '\t'
+                + (res ? res->toString() : "_") + '\t'
+                + (arg1 ? arg1->toString() : "_") + '\t'
+                + (arg2 ? arg2->toString() : "_") + '\t'
+                + '\n';
+    if (sinks & Output::Stdout) {
+        cout << line;
+    }
+    if (sinks & Output::File) {
+        IRFileStream() << line;
+    }
 }
 
 
@@ -59,6 +77,10 @@ std::string Inst::opToStr(Op anOperator) {
             return "Store";
         case Op::StoreDynamic:
             return "StoreDynamic";
+        case Op::Fill:
+            return "Fill";
+        case Op::CopyData:
+            return "CopyData";
         case Op::Add:
             return "Add";
         case Op::Sub:
@@ -139,12 +161,10 @@ std::string Inst::opToStr(Op anOperator) {
 
 
 Label::Label(std::string name, bool isFunc) {
-    static int idAllocator = 0;
-
     if (isFunc) {
         this->nameAndId = std::move(name);
     } else {
-        this->nameAndId = std::move(name) + "_" + std::to_string(idAllocator++);
+        this->nameAndId = std::move(name) + "_" + std::to_string(Context::cur().ir.labelIdAllocator++);
     }
 }
 
@@ -176,7 +196,7 @@ Function::Function(std::string name, Type reType,
     name(std::move(name)),
     reType(reType),
     params(params) {
-    idAllocator = 0;
+    idAllocator() = 0;
 }
 
 void Function::moveBasicBlocks(BasicBlocks &&bBlocks) {
@@ -184,22 +204,21 @@ void Function::moveBasicBlocks(BasicBlocks &&bBlocks) {
 }
 
 void Module::outputIR() const {
-    for (const auto &[ident, globVar]: globVars) {
-#if defined(STDOUT_IR)
-        std::cout << ident << '\n';
-#endif
-
-#if defined(FILEOUT_IR)
-        IRFileStream << ident << '\n';
-#endif
-    }
-    for (auto &i: mainFunction->getBasicBlocks()) {
+    outputGlobVarsIR();
+    mainFunction->outputIR();
+    for (auto &i: functions) {
         i->outputIR();
     }
+}
 
-    for (auto &i: functions) {
-        for (auto &j: i->getBasicBlocks()) {
-            j->outputIR();
+void Module::outputGlobVarsIR() const {
+    auto sinks = Context::cur().output.ir;
+    for (const auto &[ident, globVar]: globVars) {
+        if (sinks & Output::Stdout) {
+            std::cout << ident << '\n';
+        }
+        if (sinks & Output::File) {
+            IRFileStream() << ident << '\n';
         }
     }
 }
@@ -212,6 +231,10 @@ const Function &Module::getMainFunction() const {
     return *mainFunction;
 }
 
+Function &Module::getMainFunction() {
+    return *mainFunction;
+}
+
 void Module::setMainFunction(std::unique_ptr<Function> main_function) {
     mainFunction = std::move(main_function);
 }
@@ -224,31 +247,52 @@ void Module::addGlobVar(std::string name, GlobVar globVar) {
     globVars.emplace_back(std::move(name), std::move(globVar));
 }
 
-int Function::idAllocator = 0;
+int &Function::idAllocator() {
+    return Context::cur().ir.functionIdAllocator;
+}
 
 const BasicBlocks &Function::getBasicBlocks() const {
     return basicBlocks;
 }
 
+BasicBlocks &Function::getBasicBlocks() {
+    return basicBlocks;
+}
+
 std::vector<Param> Function::getParams() const {
     return params;
 }
 
+const std::string &Function::getName() const {
+    return name;
+}
+
 void BasicBlock::addInst(Inst inst) {
     instructions.push_back(std::move(inst));
 }
 
 BasicBlock::BasicBlock(std::string labelName, bool isFunc) :
-    label(Label(std::move(labelName), isFunc)) {}
+    label(Label(std::move(labelName), isFunc)),
+    row(curRow()) {}
+
+void Function::outputIR() const {
+    for (auto &i: basicBlocks) {
+        i->outputIR();
+    }
+}
 
 void BasicBlock::outputIR() const {
     using namespace std;
-#if defined(STDOUT_IR)
-    cout << label.nameAndId << ":" << '\n';
-#endif
-#if defined(FILEOUT_IR)
-    IRFileStream << label.nameAndId << ":" << '\n';
-#endif
+    auto sinks = Context::cur().output.ir;
+    if (!sinks) {
+        return;
+    }
+    if (sinks & Output::Stdout) {
+        cout << label.nameAndId << ":" << '\n';
+    }
+    if (sinks & Output::File) {
+        IRFileStream() << label.nameAndId << ":" << '\n';
+    }
     for (auto &i: instructions) {
         i.outputIR();
     }
@@ -298,7 +342,7 @@ std::string Var::toString() const {
 
 Temp::Temp(Type type) :
     type(type) {
-    id = Function::idAllocator++;
+    id = Function::idAllocator()++;
 }
 
 Temp::Temp(int id, Type type) :
@@ -357,10 +401,26 @@ Op IR::LexTypeToIROp(LexType n) {
 }
 
 Str::Str() {
-    static int idAllocator = 0;
-    id = idAllocator++;
+    id = Context::cur().ir.strIdAllocator++;
 }
 
 std::string Str::toString() const {
     return "str_" + std::to_string(id);
 }
+
+Range::Range(int begin, int count) :
+    begin(begin),
+    count(count) {}
+
+std::string Range::toString() const {
+    return "[" + std::to_string(begin) + ", " + std::to_string(begin + count) + ")";
+}
+
+ArrayData::ArrayData(std::vector<int> words) {
+    id = Context::cur().ir.arrayIdAllocator++;
+    MIPS_arrays().push_back(std::move(words));
+}
+
+std::string ArrayData::toString() const {
+    return "arr_" + std::to_string(id);
+}
@@ -16,7 +16,24 @@
 // like the Parser, specific genIR method is distributed in respective AST node struct.
 // IR generation is the 2nd pass (1st pass builds the AST).
 namespace IR {
-extern std::ofstream IRFileStream;
+// IR state of one compilation, owned by Context
+struct State {
+    std::ofstream IRFileStream;
+    std::vector<std::string> MIPS_strings;
+    std::vector<std::vector<int>> MIPS_arrays;
+
+    int functionIdAllocator{};
+    int labelIdAllocator{};
+    int strIdAllocator{};
+    int arrayIdAllocator{};
+
+    // source row of the statement being generated, see BasicBlock::row
+    int curRow{};
+};
+
+std::ofstream &IRFileStream();
+
+int &curRow();
 
 // @formatter:off
 enum class Op {
@@ -41,6 +58,14 @@ enum class Op {
     // *(&arg1[Var]+ arg2[Temp]) = res[Temp]
     StoreDynamic,
 
+    // store res to every element of arg2 in local array arg1
+    // arg1[Var][arg2[Range]] = res[Temp]
+    Fill,
+
+    // copy the words of res to the elements of arg2 in local array arg1
+    // arg1[Var][arg2[Range]] = res[ArrayData]
+    CopyData,
+
     // index doesn't consider sizeof(type)
     Load,
 
@@ -155,7 +180,7 @@ struct ConstVal : public Element {
 // it is done by the assembler.
 // str_{id}
 struct Str : public Element {
-    static std::vector<std::string> MIPS_strings;
+    static std::vector<std::string> &MIPS_strings();
     int id;
 
     Str();
@@ -163,6 +188,28 @@ struct Str : public Element {
     std::string toString() const override;
 };
 
+// elements [begin, begin + count) of an array
+struct Range : public Element {
+    int begin;
+    int count;
+
+    Range(int begin, int count);
+
+    std::string toString() const override;
+};
+
+// read-only words in .data, the initial values of a local array
+// arr_{id}
+struct ArrayData : public Element {
+    static std::vector<std::vector<int>> &MIPS_arrays();
+    int id;
+
+    // the words are pushed to MIPS_arrays()
+    explicit ArrayData(std::vector<int> words);
+
+    std::string toString() const override;
+};
+
 struct Inst {
     Op op;
     std::unique_ptr<Element> res;
@@ -176,7 +223,6 @@ struct Inst {
 
     void outputIR() const;
 
-private:
     static std::string opToStr(Op anOperator);
 };
 
@@ -193,6 +239,7 @@ struct BasicBlock {
     // go to next BasicBlock
     Label label; // string is good for debugging
     std::vector<Inst> instructions;
+    int row; // source row of the function or statement that made it, for profiles
 
     // if isFunc, no suffix number
     explicit BasicBlock(std::string labelName, bool isFunc = false);
@@ -215,15 +262,20 @@ class Function {
 public:
     // id for BasicBlock & Temp
     // reset to 0 at start of Function
-    static int idAllocator;
+    static int &idAllocator();
 
     Function(std::string name, Type reType, const std::vector<Param> &params);
 
     void moveBasicBlocks(BasicBlocks &&bBlocks);
 
     const BasicBlocks &getBasicBlocks() const;
+    BasicBlocks &getBasicBlocks();
 
     std::vector<Param> getParams() const;
+
+    const std::string &getName() const;
+
+    void outputIR() const;
 };
 
 // backend CodeGen should not rely on SymTab
@@ -254,12 +306,18 @@ class Module {
 public:
     explicit Module(std::string name);
 
+    // main first, then other functions
     void outputIR() const;
 
+    // only the names of global variables
+    void outputGlobVarsIR() const;
+
     const std::vector<std::pair<std::string, GlobVar>> &getGlobVars() const;
     const std::vector<std::unique_ptr<Function>> &getFunctions() const;
+    std::vector<std::unique_ptr<Function>> &getFunctions();
 
     const Function &getMainFunction() const;
+    Function &getMainFunction();
     void setMainFunction(std::unique_ptr<Function> main_function);
 
     void addFunction(std::unique_ptr<Function> function);
@@ -0,0 +1,269 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "PassManager.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "Context.h"
+#include "Passes.h"
+#include "backend/MIPS.h"
+#include "tools/Stats.h"
+
+using namespace Opt;
+
+Pipeline &Pipeline::add(std::string name, FunctionPass pass, Preserves preserves) {
+    auto timer = "optimize." + name;
+    passes.push_back({std::move(name), std::move(timer), pass, nullptr, preserves});
+    return *this;
+}
+
+Pipeline &Pipeline::add(std::string name, ModulePass pass, Preserves preserves) {
+    auto timer = "optimize." + name;
+    passes.push_back({std::move(name), std::move(timer), nullptr, pass, preserves});
+    return *this;
+}
+
+void Pipeline::run(IR::Module &module) const {
+    Stats::Timer timer("optimize");
+    ModuleAnalyses analyses(module);
+    for (std::size_t begin = 0; begin < passes.size();) {
+        if (passes[begin].modulePass) {
+            {
+                Stats::Timer passTimer(passes[begin].timer);
+                passes[begin].modulePass(module, analyses);
+            }
+            analyses.invalidate(passes[begin].preserves);
+            ++begin;
+            continue;
+        }
+
+        std::size_t end = begin;
+        while (end < passes.size() && passes[end].functionPass) {
+            ++end;
+        }
+
+        // module passes may have removed functions, collect them again
+        std::vector<IR::Function *> funcs{&module.getMainFunction()};
+        for (auto &func: module.getFunctions()) {
+            funcs.push_back(func.get());
+        }
+        std::vector<FunctionAnalyses *> funcAnalyses;
+        for (auto func: funcs) {
+            funcAnalyses.push_back(&analyses.of(*func));
+        }
+
+        Context::cur().parallelFor(funcs.size(), [&](std::size_t i) {
+            for (std::size_t p = begin; p < end; ++p) {
+                {
+                    Stats::Timer passTimer(passes[p].timer, funcs[i]->getName());
+                    passes[p].functionPass(*funcs[i], *funcAnalyses[i]);
+                }
+                funcAnalyses[i]->invalidate(passes[p].preserves);
+            }
+        });
+
+        begin = end;
+    }
+}
+
+void Pipeline::run(IR::Function &func) const {
+    Stats::Timer timer("optimize");
+    FunctionAnalyses analyses(func);
+    for (auto &pass: passes) {
+        if (pass.functionPass) {
+            {
+                Stats::Timer passTimer(pass.timer, func.getName());
+                pass.functionPass(func, analyses);
+            }
+            analyses.invalidate(pass.preserves);
+        }
+    }
+}
+
+std::size_t Pipeline::size() const {
+    return passes.size();
+}
+
+const std::string &Pipeline::name(std::size_t i) const {
+    return passes[i].name;
+}
+
+Pipeline Pipeline::prefix(std::size_t n) const {
+    Pipeline res;
+    res.passes.assign(passes.begin(), passes.begin() + static_cast<std::ptrdiff_t>(std::min(n, passes.size())));
+    return res;
+}
+
+Pipeline Pipeline::subset(const std::vector<bool> &keep) const {
+    Pipeline res;
+    for (std::size_t i = 0; i < passes.size() && i < keep.size(); ++i) {
+        if (keep[i]) {
+            res.passes.push_back(passes[i]);
+        }
+    }
+    return res;
+}
+
+namespace {
+const char *const FOLD_OFFSETS = "foldOffsets";
+
+// the IR passes in the order of -O2
+struct IRPass {
+    const char *name;
+    FunctionPass functionPass;
+    ModulePass modulePass;
+    Preserves preserves;
+};
+
+const IRPass irPasses[] = {
+        {"foldConstants", foldConstants, nullptr, Preserves::all()},
+        {"removeJumpToNext", removeJumpToNext, nullptr, Preserves::all()},
+        {"removeUncalledFunctions", nullptr, removeUncalledFunctions, {true, false}},
+};
+
+const IRPass *findIRPass(const std::string &name) {
+    for (auto &pass: irPasses) {
+        if (name == pass.name) {
+            return &pass;
+        }
+    }
+    return nullptr;
+}
+
+const MIPS::Peephole *findPeephole(const std::string &name) {
+    for (auto &peephole: MIPS::peepholes()) {
+        if (name == peephole.name) {
+            return &peephole;
+        }
+    }
+    return nullptr;
+}
+
+// append the optimization called name to its phase, even if config has it
+void add(Config &config, const std::string &name) {
+    if (name == FOLD_OFFSETS) {
+        config.foldOffsets = true;
+    } else if (auto irPass = findIRPass(name)) {
+        if (irPass->functionPass) {
+            config.pipeline.add(name, irPass->functionPass, irPass->preserves);
+        } else {
+            config.pipeline.add(name, irPass->modulePass, irPass->preserves);
+        }
+    } else if (auto peephole = findPeephole(name)) {
+        config.peepholes.push_back(peephole);
+    } else {
+        std::string known;
+        for (auto phase: {Phase::GenIR, Phase::IR, Phase::MIPS}) {
+            for (auto &pass: passNames(phase)) {
+                known += " " + pass;
+            }
+        }
+        throw std::invalid_argument("no optimization " + name + ", there are:" + known);
+    }
+}
+} // namespace
+
+Config Opt::level(int level) {
+    if (level < 0 || level > MAX_LEVEL) {
+        throw std::invalid_argument("no -O" + std::to_string(level));
+    }
+    Config config;
+    if (level >= 1) {
+        config.foldOffsets = true;
+        for (auto &peephole: MIPS::peepholes()) {
+            config.peepholes.push_back(&peephole);
+        }
+    }
+    if (level >= 2) {
+        for (auto &pass: irPasses) {
+            add(config, pass.name);
+        }
+    }
+    return config;
+}
+
+std::vector<std::string> Opt::passNames(Phase phase) {
+    std::vector<std::string> res;
+    switch (phase) {
+        case Phase::GenIR:
+            res.emplace_back(FOLD_OFFSETS);
+            break;
+        case Phase::IR:
+            for (auto &pass: irPasses) {
+                res.emplace_back(pass.name);
+            }
+            break;
+        case Phase::MIPS:
+            for (auto &peephole: MIPS::peepholes()) {
+                res.emplace_back(peephole.name);
+            }
+            break;
+    }
+    return res;
+}
+
+bool Opt::has(const Config &config, const std::string &name) {
+    if (name == FOLD_OFFSETS) {
+        return config.foldOffsets;
+    }
+    for (std::size_t i = 0; i < config.pipeline.size(); ++i) {
+        if (config.pipeline.name(i) == name) {
+            return true;
+        }
+    }
+    return std::any_of(config.peepholes.begin(), config.peepholes.end(),
+                       [&](const MIPS::Peephole *peephole) { return name == peephole->name; });
+}
+
+void Opt::enable(Config &config, const std::string &name, bool on) {
+    if (on) {
+        if (!has(config, name)) {
+            add(config, name);
+        }
+    } else if (name == FOLD_OFFSETS) {
+        config.foldOffsets = false;
+    } else if (findIRPass(name)) {
+        std::vector<bool> keep;
+        for (std::size_t i = 0; i < config.pipeline.size(); ++i) {
+            keep.push_back(config.pipeline.name(i) != name);
+        }
+        config.pipeline = config.pipeline.subset(keep);
+    } else if (auto peephole = findPeephole(name)) {
+        auto &peepholes = config.peepholes;
+        peepholes.erase(std::remove(peepholes.begin(), peepholes.end(), peephole), peepholes.end());
+    } else {
+        add(config, name); // throws
+    }
+}
+
+Config Opt::parse(const std::string &spec) {
+    Config config;
+    std::size_t begin = 0;
+    while (begin < spec.size()) {
+        auto end = std::min(spec.find(',', begin), spec.size());
+        auto name = spec.substr(begin, end - begin);
+        begin = end + 1;
+        if (!name.empty()) {
+            add(config, name);
+        }
+    }
+    return config;
+}
+
+std::vector<std::string> Opt::names(const Config &config) {
+    std::vector<std::string> res;
+    if (config.foldOffsets) {
+        res.emplace_back(FOLD_OFFSETS);
+    }
+    for (std::size_t i = 0; i < config.pipeline.size(); ++i) {
+        res.push_back(config.pipeline.name(i));
+    }
+    for (auto peephole: config.peepholes) {
+        res.emplace_back(peephole->name);
+    }
+    return res;
+}
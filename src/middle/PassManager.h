@@ -0,0 +1,108 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_PASSMANAGER_H
+#define COMPILER_PASSMANAGER_H
+
+#include "Analyses.h"
+#include "IR.h"
+
+#include <string>
+#include <vector>
+
+namespace MIPS {
+struct Peephole;
+}
+
+// IR optimization driver, runs between CompUnit::genIR and MIPS::genMIPS.
+namespace Opt {
+// intraprocedural, may only touch the given Function
+using FunctionPass = void (*)(IR::Function &, FunctionAnalyses &);
+
+// interprocedural, sees the whole Module
+using ModulePass = void (*)(IR::Module &, ModuleAnalyses &);
+
+// A Pipeline is an ordered list of passes.
+// Consecutive function passes form a stage: each function runs the whole stage by itself,
+// different functions run in parallel on the pool of Context.
+// A module pass is a barrier: it starts after every function finishes the stages before it,
+// and the stages after it start when it returns.
+// Passes never share state across functions, so the result is independent of the thread count.
+// Analyses live across the whole run, each pass drops those it does not preserve.
+class Pipeline {
+public:
+    Pipeline &add(std::string name, FunctionPass pass, Preserves preserves = {});
+    Pipeline &add(std::string name, ModulePass pass, Preserves preserves = {});
+
+    void run(IR::Module &module) const;
+
+    // run the function passes on func alone, module passes are skipped
+    // used when functions are compiled one by one, see CompUnit::stream
+    void run(IR::Function &func) const;
+
+    std::size_t size() const;
+    const std::string &name(std::size_t i) const;
+
+    // the first n passes, to see what each pass does
+    Pipeline prefix(std::size_t n) const;
+
+    // the passes i with keep[i], in their order, to turn passes on and off one by one
+    Pipeline subset(const std::vector<bool> &keep) const;
+
+private:
+    struct Pass {
+        std::string name;
+        std::string timer; // "optimize.<name>", see Stats::Timer
+        FunctionPass functionPass{};
+        ModulePass modulePass{};
+        Preserves preserves;
+    };
+
+    std::vector<Pass> passes;
+};
+
+// where an optimization runs
+enum class Phase {
+    GenIR, // while CompUnit::genIR generates the IR
+    IR,    // a pass of the Pipeline
+    MIPS,  // a peephole on the assemblies of each function
+};
+
+// every optimization of one compilation
+struct Config {
+    // LVal::getOffset folds constant subscripts into the offset, see ExpState::foldOffsets
+    bool foldOffsets{};
+    Pipeline pipeline;
+    // run in this order, see MIPS::State::peepholes
+    std::vector<const MIPS::Peephole *> peepholes;
+};
+
+// -O<level>
+// 0: nothing
+// 1: what needs no IR pass: foldOffsets and every MIPS::peepholes()
+// 2: 1 and the IR passes, what compile() does by default
+constexpr int MAX_LEVEL = 2;
+constexpr int DEFAULT_LEVEL = 2;
+Config level(int level);
+
+// every optimization of phase, by name, in the order it runs at MAX_LEVEL
+std::vector<std::string> passNames(Phase phase);
+
+bool has(const Config &config, const std::string &name);
+
+// on: add the optimization called name at the end of its phase, unless config has it
+// off: remove it from config
+// throw std::invalid_argument if nothing is called name
+void enable(Config &config, const std::string &name, bool on);
+
+// comma separated names like "foldOffsets,removeJumpToNext,foldConstants,mergeLi_R",
+// each phase runs its optimizations in the given order, a pass may be given more than once
+// "" is -O0, throw std::invalid_argument on an unknown name
+Config parse(const std::string &spec);
+
+// the optimizations of config in the order they run, parse() takes them back joined by ','
+std::vector<std::string> names(const Config &config);
+} // namespace Opt
+
+#endif
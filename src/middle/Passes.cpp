@@ -0,0 +1,246 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Passes.h"
+
+#include <climits>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace IR;
+
+namespace {
+// a Temp defined by LoadImd in the current BasicBlock
+struct Known {
+    int value;
+    std::size_t def; // index of the LoadImd
+};
+
+// same results as the MIPS instructions: wrap around on overflow
+bool evaluate(Op op, int a, int b, int &res) {
+    auto ua = static_cast<std::uint32_t>(a);
+    auto ub = static_cast<std::uint32_t>(b);
+    switch (op) {
+        case Op::Add:
+            res = static_cast<int>(ua + ub);
+            return true;
+        case Op::Sub:
+            res = static_cast<int>(ua - ub);
+            return true;
+        case Op::Mul:
+            res = static_cast<int>(ua * ub);
+            return true;
+        case Op::Div:
+        case Op::Mod:
+            // keep the runtime behavior of div by 0 and overflow
+            if (b == 0 || (a == INT_MIN && b == -1)) {
+                return false;
+            }
+            res = op == Op::Div ? a / b : a % b;
+            return true;
+        case Op::Leq:
+            res = a <= b;
+            return true;
+        case Op::Lss:
+            res = a < b;
+            return true;
+        case Op::Geq:
+            res = a >= b;
+            return true;
+        case Op::Gre:
+            res = a > b;
+            return true;
+        case Op::Eql:
+            res = a == b;
+            return true;
+        case Op::Neq:
+            res = a != b;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void foldBlock(BasicBlock &block) {
+    auto &insts = block.instructions;
+    std::unordered_map<int, Known> known;
+    std::vector<bool> dead(insts.size(), false);
+
+    // take the constant in Temp e, its LoadImd is dead
+    auto take = [&](const std::unique_ptr<Element> &e, int &value) {
+        auto temp = dynamic_cast<Temp *>(e.get());
+        if (!temp || temp->id < 0) {
+            return false;
+        }
+        auto it = known.find(temp->id);
+        if (it == known.end()) {
+            return false;
+        }
+        value = it->second.value;
+        dead[it->second.def] = true;
+        known.erase(it);
+        return true;
+    };
+
+    auto isKnown = [&](const std::unique_ptr<Element> &e) {
+        auto temp = dynamic_cast<Temp *>(e.get());
+        return temp && temp->id >= 0 && known.count(temp->id);
+    };
+
+    auto toLoadImd = [&](Inst &inst, std::size_t i, int value) {
+        auto res = dynamic_cast<Temp *>(inst.res.get());
+        inst.op = Op::LoadImd;
+        inst.arg1 = std::make_unique<ConstVal>(value, res->type);
+        inst.arg2 = nullptr;
+        if (res->id >= 0) {
+            known[res->id] = {value, i};
+        }
+    };
+
+    for (std::size_t i = 0; i < insts.size(); ++i) {
+        auto &inst = insts[i];
+        int a, b, res;
+        switch (inst.op) {
+            case Op::LoadImd: {
+                auto temp = dynamic_cast<Temp *>(inst.res.get());
+                if (temp->id >= 0) {
+                    known[temp->id] = {dynamic_cast<ConstVal *>(inst.arg1.get())->value, i};
+                }
+                break;
+            }
+            case Op::Add:
+            case Op::Sub:
+            case Op::Mul:
+            case Op::Div:
+            case Op::Mod:
+            case Op::Leq:
+            case Op::Lss:
+            case Op::Geq:
+            case Op::Gre:
+            case Op::Eql:
+            case Op::Neq:
+                if (isKnown(inst.arg1) && isKnown(inst.arg2)) {
+                    auto id1 = dynamic_cast<Temp *>(inst.arg1.get())->id;
+                    auto id2 = dynamic_cast<Temp *>(inst.arg2.get())->id;
+                    if (id1 == id2) {
+                        break;
+                    }
+                    a = known[id1].value;
+                    b = known[id2].value;
+                    if (evaluate(inst.op, a, b, res)) {
+                        take(inst.arg1, a);
+                        take(inst.arg2, b);
+                        toLoadImd(inst, i, res);
+                    }
+                }
+                break;
+            case Op::MulImd:
+                if (take(inst.arg1, a)) {
+                    b = dynamic_cast<ConstVal *>(inst.arg2.get())->value;
+                    evaluate(Op::Mul, a, b, res);
+                    toLoadImd(inst, i, res);
+                }
+                break;
+            case Op::Mult4:
+                if (take(inst.arg1, a)) {
+                    toLoadImd(inst, i, static_cast<int>(static_cast<std::uint32_t>(a) << 2));
+                }
+                break;
+            case Op::Neg:
+                if (take(inst.arg1, a)) {
+                    toLoadImd(inst, i, static_cast<int>(0u - static_cast<std::uint32_t>(a)));
+                }
+                break;
+            case Op::Not:
+                if (take(inst.arg1, a)) {
+                    toLoadImd(inst, i, a == 0);
+                }
+                break;
+            case Op::NewMove:
+                if (take(inst.arg1, a)) {
+                    toLoadImd(inst, i, a);
+                }
+                break;
+            case Op::Bif0:
+            case Op::Bif1:
+                if (take(inst.arg1, a)) {
+                    bool jump = (inst.op == Op::Bif0) == (a == 0);
+                    if (jump) {
+                        inst.op = Op::Br;
+                        inst.arg1 = std::move(inst.arg2);
+                    } else {
+                        dead[i] = true;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::vector<Inst> live;
+    live.reserve(insts.size());
+    for (std::size_t i = 0; i < insts.size(); ++i) {
+        if (!dead[i]) {
+            live.push_back(std::move(insts[i]));
+        }
+    }
+    insts = std::move(live);
+}
+} // namespace
+
+void Opt::foldConstants(Function &func, FunctionAnalyses &) {
+    for (auto &block: func.getBasicBlocks()) {
+        foldBlock(*block);
+    }
+}
+
+void Opt::removeJumpToNext(Function &func, FunctionAnalyses &analyses) {
+    auto &blocks = func.getBasicBlocks();
+    auto &index = analyses.blockIndex();
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        auto &insts = blocks[i]->instructions;
+        if (insts.empty() || insts.back().op != Op::Br) {
+            continue;
+        }
+        auto target = index.find(dynamic_cast<Label *>(insts.back().arg1.get())->nameAndId);
+        if (target == index.end() || target->second <= i) {
+            continue;
+        }
+        // empty BasicBlocks in between fall through too
+        std::size_t j = i + 1;
+        while (j < target->second && blocks[j]->instructions.empty()) {
+            ++j;
+        }
+        if (j == target->second) {
+            insts.pop_back();
+        }
+    }
+}
+
+void Opt::removeUncalledFunctions(Module &module, ModuleAnalyses &analyses) {
+    auto &graph = analyses.callGraph();
+
+    std::unordered_set<std::string> called;
+    std::vector<const std::string *> work{&module.getMainFunction().getName()};
+    while (!work.empty()) {
+        auto func = work.back();
+        work.pop_back();
+        for (auto &name: graph.at(*func)) {
+            if (called.insert(name).second) {
+                work.push_back(&name);
+            }
+        }
+    }
+
+    auto &funcs = module.getFunctions();
+    std::vector<std::unique_ptr<Function>> kept;
+    for (auto &func: funcs) {
+        if (called.count(func->getName())) {
+            kept.push_back(std::move(func));
+        }
+    }
+    funcs = std::move(kept);
+}
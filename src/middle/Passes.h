@@ -0,0 +1,29 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_PASSES_H
+#define COMPILER_PASSES_H
+
+#include "Analyses.h"
+#include "IR.h"
+
+// IR optimization passes, scheduled by Opt::Pipeline.
+// Every Temp is used once after its definition (MIPS::getReg frees its register),
+// passes rely on that and keep it true.
+namespace Opt {
+// evaluate operations whose operands are LoadImd Temps of the same BasicBlock,
+// and turn Bif0/Bif1 on such a Temp into Br or nothing
+// preserves every analysis: no BasicBlock or Call is added or removed
+void foldConstants(IR::Function &func, FunctionAnalyses &analyses);
+
+// remove Br whose target is the next non-empty BasicBlock
+// preserves every analysis
+void removeJumpToNext(IR::Function &func, FunctionAnalyses &analyses);
+
+// remove functions that main can never call
+// preserves the analyses of the functions left, not the CallGraph
+void removeUncalledFunctions(IR::Module &module, ModuleAnalyses &analyses);
+} // namespace Opt
+
+#endif
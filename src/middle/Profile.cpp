@@ -0,0 +1,117 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Profile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace Profile;
+
+void Profile::record(const IR::Function &func, Blocks &blocks) {
+    for (auto &block: func.getBasicBlocks()) {
+        blocks[block->label.nameAndId] = {func.getName(), block->row};
+    }
+}
+
+void Frequencies::add(const std::string &function, const std::string &label, std::int64_t count) {
+    of[function][label] += count;
+}
+
+bool Frequencies::has(const std::string &function) const {
+    return of.find(function) != of.end();
+}
+
+std::int64_t Frequencies::count(const std::string &function, const std::string &label) const {
+    auto func = of.find(function);
+    if (func == of.end()) {
+        return 0;
+    }
+    auto block = func->second.find(label);
+    return block == func->second.end() ? 0 : block->second;
+}
+
+Frequencies Frequencies::read(const std::string &file) {
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("Reading " + file + " fails!");
+    }
+
+    Frequencies res;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string function, label;
+        std::int64_t count;
+        if (!(fields >> function)) {
+            continue;
+        }
+        if (!(fields >> label >> count) || count < 0) {
+            throw std::runtime_error(file + ":" + std::to_string(lineNo) + ": expect <function> <label> <count>");
+        }
+        res.add(function, label, count);
+    }
+    return res;
+}
+
+void Frequencies::write(std::ostream &out) const {
+    // sorted, so profiles of the same run compare equal
+    std::vector<std::pair<std::string, std::string>> keys;
+    for (auto &[function, blocks]: of) {
+        for (auto &[label, count]: blocks) {
+            keys.emplace_back(function, label);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::string res = "# <function> <label> <count>\n";
+    for (auto &[function, label]: keys) {
+        res += function + ' ' + label + ' ' + std::to_string(count(function, label)) + '\n';
+    }
+    out << res;
+}
+
+std::vector<IR::Var> Profile::hotVars(const IR::Function &func, const Frequencies &frequencies) {
+    // in the order of Alloca, which is the order MIPS::Alloca hands out $s registers without a profile
+    std::vector<IR::Var> vars;
+    std::unordered_map<IR::Var, std::int64_t> uses;
+    for (auto &block: func.getBasicBlocks()) {
+        for (auto &inst: block->instructions) {
+            if (inst.op != IR::Op::Alloca) {
+                continue;
+            }
+            auto var = dynamic_cast<IR::Var *>(inst.arg1.get());
+            auto size = dynamic_cast<IR::ConstVal *>(inst.arg2.get());
+            if (size->value == 1 && uses.emplace(*var, 0).second) {
+                vars.push_back(*var);
+            }
+        }
+    }
+
+    for (auto &block: func.getBasicBlocks()) {
+        auto count = frequencies.count(func.getName(), block->label.nameAndId);
+        if (count == 0) {
+            continue;
+        }
+        for (auto &inst: block->instructions) {
+            if (inst.op != IR::Op::Load && inst.op != IR::Op::Store) {
+                continue;
+            }
+            auto var = dynamic_cast<IR::Var *>(inst.arg1.get());
+            auto use = uses.find(*var);
+            if (use != uses.end()) {
+                use->second += count;
+            }
+        }
+    }
+
+    std::stable_sort(vars.begin(), vars.end(),
+                     [&](const IR::Var &a, const IR::Var &b) { return uses[a] > uses[b]; });
+    vars.erase(std::find_if(vars.begin(), vars.end(), [&](const IR::Var &v) { return uses[v] == 0; }), vars.end());
+    return vars;
+}
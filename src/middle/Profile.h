@@ -0,0 +1,52 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_PROFILE_H
+#define COMPILER_PROFILE_H
+
+#include "IR.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+// Block frequencies of a profiled run, keyed by function name and IR::BasicBlock label.
+// Written by "Compiler --profile", read back by "--use-profile" to guide the backend.
+namespace Profile {
+// where a label of mips.txt came from, recorded while compiling
+struct Block {
+    std::string function;
+    int row{}; // BasicBlock::row
+};
+
+// by BasicBlock label
+using Blocks = std::unordered_map<std::string, Block>;
+
+void record(const IR::Function &func, Blocks &blocks);
+
+class Frequencies {
+public:
+    void add(const std::string &function, const std::string &label, std::int64_t count);
+
+    bool has(const std::string &function) const;
+
+    // entries of the block, 0 if it never ran or is not in the profile
+    std::int64_t count(const std::string &function, const std::string &label) const;
+
+    // lines "<function> <label> <count>", '#' starts a comment
+    // throw std::runtime_error on a bad file
+    static Frequencies read(const std::string &file);
+    void write(std::ostream &out) const;
+
+private:
+    std::unordered_map<std::string, std::unordered_map<std::string, std::int64_t>> of;
+};
+
+// scalar local variables worth keeping in $s registers:
+// by the profiled executions of the Load and Store of each in func, the hottest first, never-used ones left out
+std::vector<IR::Var> hotVars(const IR::Function &func, const Frequencies &frequencies);
+} // namespace Profile
+
+#endif
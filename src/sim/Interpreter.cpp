@@ -0,0 +1,709 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Interpreter.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <sstream>
+#include <stack>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "Simulator.h"
+
+using namespace Interp;
+using IR::Op;
+
+namespace {
+constexpr std::size_t MAX_MEMORY_WORDS = 1u << 26; // 256 MiB of globals and frames
+
+// where a Var lives, addresses are in bytes
+struct Loc {
+    enum class Kind : std::uint8_t {
+        Global,  // address
+        Frame,   // offset in the frame
+        Pointer, // offset in the frame of an array parameter, the word there is the address of the array
+    };
+
+    Kind kind{Kind::Global};
+    std::int32_t offset{};
+};
+
+// one IR::Inst with its operands resolved
+// temps are slots of the frame: Temp id + 1, slot 0 is $v0, written by GetInt and the Ret of a callee
+struct Code {
+    Op op{};
+    std::int32_t res{};  // Temp slot
+    std::int32_t arg1{}; // Temp slot
+    std::int32_t arg2{}; // Temp slot, -1 if the operand is imm
+    std::int32_t imm{};  // ConstVal, byte offset, jump target, callee, string or array
+    std::int32_t count{}; // words of Fill and CopyData
+    Loc loc;
+};
+
+struct Func {
+    std::string name;
+    std::vector<Code> code;
+    std::int32_t params{};
+    std::int32_t frameWords{};
+    std::int32_t temps{};
+};
+
+struct Decoded {
+    std::vector<Func> funcs; // main first
+    std::vector<std::int32_t> globals; // initial memory
+    std::vector<std::string> strings;
+    std::vector<std::vector<std::int32_t>> arrays;
+};
+
+std::runtime_error decodeError(const std::string &func, const std::string &what) {
+    return std::runtime_error("IR of " + func + ": " + what);
+}
+
+class Decoder {
+public:
+    explicit Decoder(const IR::Module &module) :
+        module(module) {}
+
+    Decoded decode() {
+        for (auto &[name, globVar]: module.getGlobVars()) {
+            globals[name] = static_cast<std::int32_t>(res.globals.size() * 4);
+            res.globals.insert(res.globals.end(), globVar.initVal.begin(), globVar.initVal.end());
+        }
+        for (auto &str: IR::Str::MIPS_strings()) {
+            res.strings.push_back(Sim::unescape(str));
+        }
+        for (auto &words: IR::ArrayData::MIPS_arrays()) {
+            res.arrays.emplace_back(words.begin(), words.end());
+        }
+
+        std::vector<const IR::Function *> funcs{&module.getMainFunction()};
+        for (auto &func: module.getFunctions()) {
+            funcs.push_back(func.get());
+        }
+        for (std::size_t i = 0; i < funcs.size(); ++i) {
+            funcIds[funcs[i]->getName()] = static_cast<std::int32_t>(i);
+        }
+        for (auto func: funcs) {
+            res.funcs.push_back(decode(*func));
+        }
+        return std::move(res);
+    }
+
+private:
+    const IR::Module &module;
+    Decoded res;
+    std::unordered_map<std::string, std::int32_t> globals;
+    std::unordered_map<std::string, std::int32_t> funcIds;
+
+    // of the function being decoded
+    const std::string *name{};
+    std::unordered_map<IR::Var, Loc> vars;
+    std::int32_t temps{};
+
+    std::int32_t temp(const IR::Element *element) {
+        auto t = dynamic_cast<const IR::Temp *>(element);
+        if (!t) {
+            throw decodeError(*name, "expect a Temp");
+        }
+        if (t->id < 0) {
+            // only $v0 is used as a Temp
+            return 0;
+        }
+        temps = std::max(temps, t->id + 2);
+        return t->id + 1;
+    }
+
+    std::int32_t constVal(const IR::Element *element) {
+        auto c = dynamic_cast<const IR::ConstVal *>(element);
+        if (!c) {
+            throw decodeError(*name, "expect a ConstVal");
+        }
+        return c->value;
+    }
+
+    Loc loc(const IR::Element *element) {
+        auto var = dynamic_cast<const IR::Var *>(element);
+        if (!var) {
+            throw decodeError(*name, "expect a Var");
+        }
+        if (var->depth == 0) {
+            auto global = globals.find(var->name);
+            if (global == globals.end()) {
+                throw decodeError(*name, "unknown global " + var->name);
+            }
+            return {Loc::Kind::Global, global->second};
+        }
+        auto local = vars.find(*var);
+        if (local == vars.end()) {
+            throw decodeError(*name, "unknown variable " + var->toString());
+        }
+        return local->second;
+    }
+
+    // the Temp slot of a dynamic byte offset, or -1 and the byte offset of a ConstVal index
+    void offset(const IR::Element *element, Code &code) {
+        if (dynamic_cast<const IR::ConstVal *>(element)) {
+            code.arg2 = -1;
+            code.imm = constVal(element) * 4;
+        } else {
+            code.arg2 = temp(element);
+        }
+    }
+
+    Func decode(const IR::Function &func) {
+        Func f;
+        f.name = func.getName();
+        name = &f.name;
+        vars.clear();
+        temps = 1;
+
+        // parameters are the first words of the frame, like the stack layout in Memory.h
+        auto params = func.getParams();
+        for (auto &[ident, sym]: params) {
+            auto kind = sym->dims.empty() ? Loc::Kind::Frame : Loc::Kind::Pointer;
+            vars[IR::Var(ident, 1)] = {kind, f.params * 4};
+            ++f.params;
+        }
+
+        // Alloca takes the next words, OutStack gives back the words of its scope
+        std::int32_t cur = f.params;
+        std::stack<std::int32_t> scopes;
+        f.frameWords = cur;
+
+        std::unordered_map<std::string, std::int32_t> labels;
+        std::vector<std::pair<std::size_t, std::string>> jumps;
+
+        for (auto &block: func.getBasicBlocks()) {
+            labels[block->label.nameAndId] = static_cast<std::int32_t>(f.code.size());
+            for (auto &inst: block->instructions) {
+                Code code;
+                code.op = inst.op;
+                switch (inst.op) {
+                    case Op::Empty:
+                        continue;
+                    case Op::InStack:
+                        scopes.push(cur);
+                        break;
+                    case Op::OutStack:
+                        if (scopes.empty()) {
+                            throw decodeError(f.name, "OutStack without InStack");
+                        }
+                        cur = scopes.top();
+                        scopes.pop();
+                        break;
+                    case Op::Alloca: {
+                        auto var = dynamic_cast<const IR::Var *>(inst.arg1.get());
+                        if (!var) {
+                            throw decodeError(f.name, "expect a Var");
+                        }
+                        vars[*var] = {Loc::Kind::Frame, cur * 4};
+                        cur += constVal(inst.arg2.get());
+                        f.frameWords = std::max(f.frameWords, cur);
+                        break;
+                    }
+                    case Op::Store:
+                    case Op::Load:
+                        code.res = temp(inst.res.get());
+                        code.loc = loc(inst.arg1.get());
+                        code.imm = inst.arg2 ? constVal(inst.arg2.get()) * 4 : 0;
+                        break;
+                    case Op::StoreDynamic:
+                    case Op::LoadDynamic:
+                        code.res = temp(inst.res.get());
+                        code.loc = loc(inst.arg1.get());
+                        code.arg2 = temp(inst.arg2.get());
+                        break;
+                    case Op::Fill:
+                    case Op::CopyData: {
+                        if (inst.op == Op::Fill) {
+                            code.res = temp(inst.res.get());
+                        } else {
+                            auto data = dynamic_cast<const IR::ArrayData *>(inst.res.get());
+                            if (!data || data->id >= static_cast<int>(res.arrays.size())) {
+                                throw decodeError(f.name, "unknown ArrayData");
+                            }
+                            code.res = data->id;
+                        }
+                        code.loc = loc(inst.arg1.get());
+                        auto range = dynamic_cast<const IR::Range *>(inst.arg2.get());
+                        if (!range || code.loc.kind != Loc::Kind::Frame) {
+                            throw decodeError(f.name, "expect a Range of a local array");
+                        }
+                        code.imm = range->begin * 4;
+                        code.count = range->count;
+                        break;
+                    }
+                    case Op::LoadPtr:
+                        code.res = temp(inst.res.get());
+                        code.arg1 = temp(inst.arg1.get());
+                        code.imm = inst.arg2 ? constVal(inst.arg2.get()) * 4 : 0;
+                        break;
+                    case Op::Add:
+                    case Op::Sub:
+                    case Op::Mul:
+                    case Op::Div:
+                    case Op::Mod:
+                    case Op::And:
+                    case Op::Or:
+                    case Op::Leq:
+                    case Op::Lss:
+                    case Op::Geq:
+                    case Op::Gre:
+                    case Op::Eql:
+                    case Op::Neq:
+                        code.res = temp(inst.res.get());
+                        code.arg1 = temp(inst.arg1.get());
+                        code.arg2 = temp(inst.arg2.get());
+                        break;
+                    case Op::LoadImd:
+                        code.res = temp(inst.res.get());
+                        code.imm = constVal(inst.arg1.get());
+                        break;
+                    case Op::MulImd:
+                        code.res = temp(inst.res.get());
+                        code.arg1 = temp(inst.arg1.get());
+                        code.imm = constVal(inst.arg2.get());
+                        break;
+                    case Op::Neg:
+                    case Op::Mult4:
+                    case Op::NewMove:
+                    case Op::Not:
+                        code.res = temp(inst.res.get());
+                        code.arg1 = temp(inst.arg1.get());
+                        break;
+                    case Op::GetInt:
+                        break;
+                    case Op::PrintInt:
+                    case Op::PushParam:
+                        code.arg1 = temp(inst.arg1.get());
+                        break;
+                    case Op::PrintStr: {
+                        auto str = dynamic_cast<const IR::Str *>(inst.arg1.get());
+                        if (!str || str->id >= static_cast<int>(res.strings.size())) {
+                            throw decodeError(f.name, "unknown Str");
+                        }
+                        code.imm = str->id;
+                        break;
+                    }
+                    case Op::Br:
+                        jumps.emplace_back(f.code.size(), dynamic_cast<const IR::Label &>(*inst.arg1).nameAndId);
+                        break;
+                    case Op::Bif0:
+                    case Op::Bif1:
+                        code.arg1 = temp(inst.arg1.get());
+                        jumps.emplace_back(f.code.size(), dynamic_cast<const IR::Label &>(*inst.arg2).nameAndId);
+                        break;
+                    case Op::Call: {
+                        auto &callee = dynamic_cast<const IR::Label &>(*inst.arg1).nameAndId;
+                        auto id = funcIds.find(callee);
+                        if (id == funcIds.end()) {
+                            throw decodeError(f.name, "call of unknown function " + callee);
+                        }
+                        code.imm = id->second;
+                        break;
+                    }
+                    case Op::Ret:
+                    case Op::RetMain:
+                        code.arg1 = inst.arg1 ? temp(inst.arg1.get()) : -1;
+                        break;
+                    case Op::PushAddressParam:
+                        code.loc = loc(inst.arg1.get());
+                        offset(inst.arg2.get(), code);
+                        break;
+                }
+                f.code.push_back(code);
+            }
+        }
+
+        for (auto &[at, label]: jumps) {
+            auto target = labels.find(label);
+            if (target == labels.end()) {
+                throw decodeError(f.name, "jump to unknown label " + label);
+            }
+            f.code[at].imm = target->second;
+        }
+        f.temps = temps;
+        return f;
+    }
+};
+
+struct Fault {
+    std::string what;
+};
+
+class Machine {
+public:
+    Machine(const Decoded &program, std::istream &input, std::ostream &output) :
+        program(program),
+        memory(program.globals),
+        input(input),
+        output(output) {}
+
+    ~Machine() {
+        flush();
+    }
+
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
+
+    Result run(const Config &config);
+
+private:
+    struct Frame {
+        const Func *func;
+        std::size_t pc;
+        std::size_t base;  // first word of the frame in memory
+        std::size_t temps; // first slot in temps
+    };
+
+    const Decoded &program;
+    std::vector<std::int32_t> memory; // globals, then the frames
+    std::vector<std::int32_t> temps;
+    std::vector<std::int32_t> args; // pushed by PushParam and PushAddressParam, the last parameter first
+    std::vector<Frame> frames;
+    std::istream &input;
+    std::ostream &output;
+    std::string outBuffer;
+
+    void flush() {
+        output << outBuffer;
+        outBuffer.clear();
+    }
+
+    void print(std::string_view s) {
+        outBuffer += s;
+        if (outBuffer.size() >= (1 << 16)) {
+            flush();
+        }
+    }
+
+    std::int32_t &word(std::int64_t addr) {
+        if (addr < 0 || addr % 4 != 0 || static_cast<std::size_t>(addr / 4) >= memory.size()) {
+            throw Fault{"bad address " + std::to_string(addr)};
+        }
+        return memory[static_cast<std::size_t>(addr / 4)];
+    }
+
+    // the address of a Var to write: an array parameter means the array it points to
+    std::int64_t address(const Loc &loc, const Frame &frame) {
+        switch (loc.kind) {
+            case Loc::Kind::Global:
+                return loc.offset;
+            case Loc::Kind::Frame:
+                return static_cast<std::int64_t>(frame.base) * 4 + loc.offset;
+            case Loc::Kind::Pointer:
+                return word(static_cast<std::int64_t>(frame.base) * 4 + loc.offset);
+        }
+        return 0;
+    }
+
+    // the words holding the Var itself, as Load does: an array parameter reads the pointer
+    std::int64_t slot(const Loc &loc, const Frame &frame) {
+        if (loc.kind == Loc::Kind::Pointer) {
+            return static_cast<std::int64_t>(frame.base) * 4 + loc.offset;
+        }
+        return address(loc, frame);
+    }
+
+    void call(const Func &func) {
+        if (args.size() < static_cast<std::size_t>(func.params)) {
+            throw Fault{"call of " + func.name + " without its parameters"};
+        }
+        std::size_t base = memory.size();
+        if (base + static_cast<std::size_t>(func.frameWords) > MAX_MEMORY_WORDS) {
+            throw Fault{"stack overflow in " + func.name};
+        }
+        memory.resize(base + static_cast<std::size_t>(func.frameWords));
+        for (std::int32_t i = 0; i < func.params; ++i) {
+            memory[base + static_cast<std::size_t>(i)] = args[args.size() - 1 - static_cast<std::size_t>(i)];
+        }
+        args.resize(args.size() - static_cast<std::size_t>(func.params));
+
+        std::size_t tempBase = temps.size();
+        temps.resize(tempBase + static_cast<std::size_t>(func.temps));
+        frames.push_back({&func, 0, base, tempBase});
+    }
+
+    // pop the frame, the value goes to $v0 of the caller
+    void ret(std::int32_t value) {
+        auto frame = frames.back();
+        frames.pop_back();
+        memory.resize(frame.base);
+        temps.resize(frame.temps);
+        if (!frames.empty()) {
+            temps[frames.back().temps] = value;
+        }
+    }
+};
+
+std::int32_t s(std::uint32_t v) {
+    return static_cast<std::int32_t>(v);
+}
+
+std::uint32_t u(std::int32_t v) {
+    return static_cast<std::uint32_t>(v);
+}
+
+Result Machine::run(const Config &config) {
+    Result result;
+    auto &counts = result.counts;
+    std::int64_t steps = 0;
+    auto limit = config.maxSteps > 0 ? config.maxSteps : -1;
+
+    call(program.funcs[0]);
+    try {
+        while (!frames.empty()) {
+            auto &frame = frames.back();
+            auto &code = frame.func->code;
+            if (frame.pc >= code.size()) {
+                // a void function without return, or the end of main
+                if (frames.size() == 1) {
+                    break;
+                }
+                ret(0);
+                continue;
+            }
+            if (steps == limit) {
+                result.status = Result::Status::StepLimit;
+                break;
+            }
+            ++steps;
+            auto &c = code[frame.pc++];
+            ++counts[static_cast<std::size_t>(c.op)];
+            auto *t = temps.data() + frame.temps;
+
+            switch (c.op) {
+                case Op::Empty:
+                case Op::InStack:
+                case Op::OutStack:
+                case Op::Alloca:
+                    break;
+                case Op::Store:
+                    word(address(c.loc, frame) + c.imm) = t[c.res];
+                    break;
+                case Op::StoreDynamic:
+                    word(address(c.loc, frame) + t[c.arg2]) = t[c.res];
+                    break;
+                case Op::Fill: {
+                    auto begin = address(c.loc, frame) + c.imm;
+                    for (std::int32_t i = 0; i < c.count; ++i) {
+                        word(begin + 4 * i) = t[c.res];
+                    }
+                    break;
+                }
+                case Op::CopyData: {
+                    auto begin = address(c.loc, frame) + c.imm;
+                    auto &data = program.arrays[static_cast<std::size_t>(c.res)];
+                    for (std::int32_t i = 0; i < c.count; ++i) {
+                        word(begin + 4 * i) = data[static_cast<std::size_t>(i)];
+                    }
+                    break;
+                }
+                case Op::Load:
+                    t[c.res] = word(slot(c.loc, frame) + c.imm);
+                    break;
+                case Op::LoadDynamic:
+                    t[c.res] = word(slot(c.loc, frame) + t[c.arg2]);
+                    break;
+                case Op::LoadPtr:
+                    t[c.res] = word(static_cast<std::int64_t>(t[c.arg1]) + c.imm);
+                    break;
+                case Op::Add:
+                    t[c.res] = s(u(t[c.arg1]) + u(t[c.arg2]));
+                    break;
+                case Op::Sub:
+                    t[c.res] = s(u(t[c.arg1]) - u(t[c.arg2]));
+                    break;
+                case Op::Mul:
+                    t[c.res] = s(u(t[c.arg1]) * u(t[c.arg2]));
+                    break;
+                case Op::Div:
+                case Op::Mod: {
+                    auto a = t[c.arg1];
+                    auto b = t[c.arg2];
+                    if (b == 0) {
+                        throw Fault{"division by zero in " + frame.func->name};
+                    }
+                    if (a == INT32_MIN && b == -1) {
+                        t[c.res] = c.op == Op::Div ? INT32_MIN : 0;
+                    } else {
+                        t[c.res] = c.op == Op::Div ? a / b : a % b;
+                    }
+                    break;
+                }
+                case Op::And:
+                    t[c.res] = t[c.arg1] & t[c.arg2];
+                    break;
+                case Op::Or:
+                    t[c.res] = t[c.arg1] | t[c.arg2];
+                    break;
+                case Op::Leq:
+                    t[c.res] = t[c.arg1] <= t[c.arg2];
+                    break;
+                case Op::Lss:
+                    t[c.res] = t[c.arg1] < t[c.arg2];
+                    break;
+                case Op::Geq:
+                    t[c.res] = t[c.arg1] >= t[c.arg2];
+                    break;
+                case Op::Gre:
+                    t[c.res] = t[c.arg1] > t[c.arg2];
+                    break;
+                case Op::Eql:
+                    t[c.res] = t[c.arg1] == t[c.arg2];
+                    break;
+                case Op::Neq:
+                    t[c.res] = t[c.arg1] != t[c.arg2];
+                    break;
+                case Op::LoadImd:
+                    t[c.res] = c.imm;
+                    break;
+                case Op::MulImd:
+                    t[c.res] = s(u(t[c.arg1]) * u(c.imm));
+                    break;
+                case Op::Neg:
+                    t[c.res] = s(0u - u(t[c.arg1]));
+                    break;
+                case Op::Mult4:
+                    t[c.res] = s(u(t[c.arg1]) << 2);
+                    break;
+                case Op::NewMove:
+                    t[c.res] = t[c.arg1];
+                    break;
+                case Op::Not:
+                    t[c.res] = t[c.arg1] == 0;
+                    break;
+                case Op::GetInt: {
+                    flush(); // interactive programs see the prompt first
+                    // a failed read gives 0, like the simulator
+                    std::int64_t value = 0;
+                    input >> value;
+                    t[0] = s(static_cast<std::uint32_t>(value));
+                    break;
+                }
+                case Op::PrintInt:
+                    print(std::to_string(t[c.arg1]));
+                    break;
+                case Op::PrintStr:
+                    print(program.strings[static_cast<std::size_t>(c.imm)]);
+                    break;
+                case Op::Br:
+                    frame.pc = static_cast<std::size_t>(c.imm);
+                    break;
+                case Op::Bif0:
+                    if (t[c.arg1] == 0) {
+                        frame.pc = static_cast<std::size_t>(c.imm);
+                    }
+                    break;
+                case Op::Bif1:
+                    if (t[c.arg1] != 0) {
+                        frame.pc = static_cast<std::size_t>(c.imm);
+                    }
+                    break;
+                case Op::PushParam:
+                    args.push_back(t[c.arg1]);
+                    break;
+                case Op::PushAddressParam: {
+                    auto offset = c.arg2 < 0 ? c.imm : t[c.arg2];
+                    args.push_back(static_cast<std::int32_t>(address(c.loc, frame) + offset));
+                    break;
+                }
+                case Op::Call:
+                    // frame is invalid after call
+                    call(program.funcs[static_cast<std::size_t>(c.imm)]);
+                    break;
+                case Op::Ret:
+                    if (frames.size() == 1) {
+                        frames.clear();
+                        break;
+                    }
+                    ret(c.arg1 < 0 ? 0 : t[c.arg1]);
+                    break;
+                case Op::RetMain:
+                    result.exitCode = c.arg1 < 0 ? 0 : t[c.arg1];
+                    frames.clear();
+                    break;
+            }
+        }
+    } catch (const Fault &fault) {
+        result.status = Result::Status::Fault;
+        result.fault = fault.what;
+    }
+    result.steps = steps;
+    return result;
+}
+} // namespace
+
+Result Interp::run(const IR::Module &module, std::istream &input, std::ostream &output, const Config &config) {
+    auto program = Decoder(module).decode();
+    Machine machine(program, input, output);
+    return machine.run(config);
+}
+
+void Interp::report(std::ostream &out, const Result &result) {
+    std::ostringstream res;
+    switch (result.status) {
+        case Result::Status::Exited:
+            res << "exited with " << result.exitCode << '\n';
+            break;
+        case Result::Status::StepLimit:
+            res << "stopped at the step limit\n";
+            break;
+        case Result::Status::Fault:
+            res << "fault: " << result.fault << '\n';
+            break;
+    }
+    res << "IR steps " << result.steps << '\n';
+    for (std::size_t i = 1; i < OPS; ++i) {
+        if (result.counts[i] == 0) {
+            continue;
+        }
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%-18s %12lld\n",
+                      IR::Inst::opToStr(static_cast<Op>(i)).c_str(), static_cast<long long>(result.counts[i]));
+        res << buf;
+    }
+    out << res.str();
+}
+
+void Interp::compare(std::ostream &out, const std::vector<std::string> &names, const std::vector<Result> &results) {
+    std::vector<std::size_t> widths;
+    for (auto &name: names) {
+        widths.push_back(std::max<std::size_t>(name.size(), 12) + 2);
+    }
+    auto row = [&](std::string head, auto cell) {
+        head.resize(std::max<std::size_t>(head.size(), 18), ' ');
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            auto text = cell(i);
+            head += std::string(widths[i] > text.size() ? widths[i] - text.size() : 1, ' ') + text;
+        }
+        return head + '\n';
+    };
+
+    std::string res = row("", [&](std::size_t i) { return names[i]; });
+    res += row("status", [&](std::size_t i) {
+        switch (results[i].status) {
+            case Result::Status::Exited:
+                return "exit " + std::to_string(results[i].exitCode);
+            case Result::Status::StepLimit:
+                return std::string("step limit");
+            case Result::Status::Fault:
+                break;
+        }
+        return std::string("fault");
+    });
+    res += row("IR steps", [&](std::size_t i) { return std::to_string(results[i].steps); });
+    for (std::size_t op = 1; op < OPS; ++op) {
+        bool ran = std::any_of(results.begin(), results.end(), [&](const Result &r) { return r.counts[op] != 0; });
+        if (ran) {
+            res += row(IR::Inst::opToStr(static_cast<Op>(op)),
+                       [&](std::size_t i) { return std::to_string(results[i].counts[op]); });
+        }
+    }
+    out << res;
+}
@@ -0,0 +1,54 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_INTERPRETER_H
+#define COMPILER_INTERPRETER_H
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "middle/IR.h"
+
+// Interpreter of IR::Module, runs the four-address instructions without the backend.
+// Variables are laid out like MIPS::genFunction does: Alloca takes the next words of the frame,
+// OutStack gives back the words of its scope, so the IR behaves as the code generated from it.
+namespace Interp {
+constexpr std::size_t OPS = static_cast<std::size_t>(IR::Op::Not) + 1;
+
+struct Config {
+    std::int64_t maxSteps{}; // stop after that many instructions, 0 is no limit
+};
+
+struct Result {
+    enum class Status {
+        Exited,    // RetMain, or main ran off its end
+        StepLimit,
+        Fault,     // bad address, division by zero, stack overflow ...
+    };
+
+    Status status{Status::Exited};
+    std::string fault; // what and in which function, for Status::Fault
+    std::int32_t exitCode{};
+
+    std::int64_t steps{};
+    std::array<std::int64_t, OPS> counts{}; // executions of each IR::Op
+};
+
+// run main of module, getint reads integers from input (0 once it runs out), prints go to output
+// module must be whole and generated in the current Context, which keeps its strings and arrays
+// throw std::runtime_error on IR the front end never generates
+Result run(const IR::Module &module, std::istream &input, std::ostream &output, const Config &config = {});
+
+// steps and the count of each op executed
+void report(std::ostream &out, const Result &result);
+
+// steps and the counts of several runs of a program side by side, one column each
+void compare(std::ostream &out, const std::vector<std::string> &names, const std::vector<Result> &results);
+} // namespace Interp
+
+#endif
@@ -0,0 +1,878 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Simulator.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace Sim;
+using MIPS::Op;
+
+std::string Sim::unescape(std::string_view quoted) {
+    std::string res;
+    for (std::size_t i = 1; i + 1 < quoted.size(); ++i) {
+        if (quoted[i] != '\\' || i + 2 >= quoted.size()) {
+            res += quoted[i];
+            continue;
+        }
+        switch (quoted[++i]) {
+            case 'n':
+                res += '\n';
+                break;
+            case 't':
+                res += '\t';
+                break;
+            case '0':
+                res += '\0';
+                break;
+            default:
+                res += quoted[i];
+                break;
+        }
+    }
+    return res;
+}
+
+namespace {
+// MARS memory layout
+constexpr std::uint32_t DATA_BASE = 0x10010000;
+constexpr std::uint32_t STACK_END = 0x80000000; // stack below it
+constexpr std::uint32_t SP_INIT = 0x7fffeffc;
+constexpr std::uint32_t GP_INIT = 0x10008000;
+constexpr std::uint32_t MAX_STACK = 1u << 28;
+
+constexpr std::uint8_t GP = 28, SP = 29, V0 = 2, A0 = 4, RA = 31;
+
+std::runtime_error parseError(std::size_t line, std::string_view text, const std::string &what) {
+    return std::runtime_error("line " + std::to_string(line) + ": " + what + ": " + std::string(text));
+}
+
+std::string_view trim(std::string_view s) {
+    auto begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+}
+
+bool toInt(std::string_view s, std::int32_t &value) {
+    s = trim(s);
+    std::int64_t v;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc() || end != s.data() + s.size() || v < INT32_MIN || v > UINT32_MAX) {
+        return false;
+    }
+    value = static_cast<std::int32_t>(static_cast<std::uint32_t>(v));
+    return true;
+}
+
+class Parser {
+public:
+    Program parse(std::string_view assembly) {
+        std::size_t lineNo = 0;
+        for (std::size_t begin = 0; begin < assembly.size();) {
+            auto end = assembly.find('\n', begin);
+            if (end == std::string_view::npos) {
+                end = assembly.size();
+            }
+            ++lineNo;
+            line(lineNo, assembly.substr(begin, end - begin));
+            begin = end + 1;
+        }
+
+        for (auto &fixup: fixups) {
+            auto it = program.labels.find(fixup.label);
+            if (it == program.labels.end()) {
+                throw std::runtime_error("line " + std::to_string(fixup.line) + ": undefined label " + fixup.label);
+            }
+            program.text[fixup.pc].imm += static_cast<std::int32_t>(it->second);
+        }
+
+        auto main = program.labels.find("main");
+        program.entry = main == program.labels.end() ? 0 : main->second;
+        program.textLabels.resize(program.text.size());
+        return std::move(program);
+    }
+
+private:
+    Program program;
+    bool inData{};
+
+    struct Fixup {
+        std::size_t pc;
+        std::string label;
+        std::size_t line;
+    };
+    std::vector<Fixup> fixups;
+
+    void line(std::size_t lineNo, std::string_view text) {
+        auto s = trim(text);
+        if (s.empty() || s[0] == '#') {
+            return;
+        }
+        if (s == ".data") {
+            inData = true;
+        } else if (s == ".text") {
+            inData = false;
+        } else if (inData) {
+            data(lineNo, s);
+        } else if (s.back() == ':' && s.find_first_of(" \t") == std::string_view::npos) {
+            define(lineNo, s.substr(0, s.size() - 1), static_cast<std::uint32_t>(program.text.size()));
+            program.textLabels.resize(program.text.size() + 1);
+            program.textLabels.back() = std::string(s.substr(0, s.size() - 1));
+        } else {
+            instruction(lineNo, s);
+        }
+    }
+
+    void define(std::size_t lineNo, std::string_view label, std::uint32_t value) {
+        if (!program.labels.emplace(std::string(label), value).second) {
+            throw parseError(lineNo, label, "label defined twice");
+        }
+    }
+
+    void align() {
+        program.data.resize((program.data.size() + 3) / 4 * 4);
+    }
+
+    void word(std::int32_t value) {
+        auto size = program.data.size();
+        program.data.resize(size + 4);
+        std::memcpy(program.data.data() + size, &value, 4);
+    }
+
+    // [label:] .word 1, 2 | .word v:n | .space n | .asciiz "..."
+    void data(std::size_t lineNo, std::string_view s) {
+        std::string_view label;
+        if (s[0] != '.') {
+            auto colon = s.find(':');
+            if (colon == std::string_view::npos) {
+                throw parseError(lineNo, s, "bad data");
+            }
+            label = s.substr(0, colon);
+            s = trim(s.substr(colon + 1));
+        }
+        auto space = s.find(' ');
+        auto directive = s.substr(0, space);
+        auto rest = space == std::string_view::npos ? std::string_view() : trim(s.substr(space));
+
+        if (directive == ".asciiz") {
+            if (!label.empty()) {
+                define(lineNo, label, DATA_BASE + static_cast<std::uint32_t>(program.data.size()));
+            }
+            auto str = unescape(rest);
+            program.data.insert(program.data.end(), str.begin(), str.end());
+            program.data.push_back(0);
+            return;
+        }
+
+        align();
+        if (!label.empty()) {
+            define(lineNo, label, DATA_BASE + static_cast<std::uint32_t>(program.data.size()));
+        }
+        std::int32_t value, count;
+        if (directive == ".space") {
+            if (!toInt(rest, count) || count < 0) {
+                throw parseError(lineNo, s, "bad .space");
+            }
+            program.data.resize(program.data.size() + count);
+        } else if (directive == ".word") {
+            auto colon = rest.find(':');
+            if (colon != std::string_view::npos) {
+                if (!toInt(rest.substr(0, colon), value) || !toInt(rest.substr(colon + 1), count) || count < 0) {
+                    throw parseError(lineNo, s, "bad .word");
+                }
+                for (std::int32_t i = 0; i < count; ++i) {
+                    word(value);
+                }
+                return;
+            }
+            for (std::size_t begin = 0; begin <= rest.size();) {
+                auto comma = std::min(rest.find(',', begin), rest.size());
+                if (!toInt(rest.substr(begin, comma - begin), value)) {
+                    throw parseError(lineNo, s, "bad .word");
+                }
+                word(value);
+                begin = comma + 1;
+            }
+        } else {
+            throw parseError(lineNo, s, "unknown directive");
+        }
+    }
+
+    static Op op(std::string_view name) {
+        for (std::size_t i = 1; i < OPS; ++i) {
+            if (MIPS::opName(static_cast<Op>(i)) == name) {
+                return static_cast<Op>(i);
+            }
+        }
+        return Op::none;
+    }
+
+    static bool reg(std::string_view s, std::uint8_t &r) {
+        for (std::size_t i = 0; i < static_cast<std::size_t>(MIPS::Register::none); ++i) {
+            if (MIPS::regName(static_cast<MIPS::Register>(i)) == s) {
+                r = static_cast<std::uint8_t>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::uint8_t regOperand(std::size_t lineNo, std::string_view s) {
+        std::uint8_t r;
+        if (!reg(s, r)) {
+            throw parseError(lineNo, s, "bad register");
+        }
+        return r;
+    }
+
+    std::int32_t immOperand(std::size_t lineNo, std::string_view s) {
+        std::int32_t value;
+        if (!toInt(s, value)) {
+            throw parseError(lineNo, s, "bad immediate");
+        }
+        return value;
+    }
+
+    void labelOperand(std::size_t lineNo, std::string_view s, Inst &inst) {
+        fixups.push_back({program.text.size(), std::string(trim(s)), lineNo});
+        inst.imm = 0;
+    }
+
+    // 8($sp) | label | label + 8 | label($t0) | label + 8($t0)
+    void addressOperand(std::size_t lineNo, std::string_view s, Inst &inst) {
+        inst.rs = 0;
+        auto paren = s.find('(');
+        if (paren != std::string_view::npos) {
+            if (s.back() != ')') {
+                throw parseError(lineNo, s, "bad address");
+            }
+            inst.rs = regOperand(lineNo, s.substr(paren + 1, s.size() - paren - 2));
+            s = trim(s.substr(0, paren));
+        }
+        std::int32_t offset = 0;
+        if (toInt(s, offset)) {
+            inst.imm = offset;
+            return;
+        }
+        auto plus = s.find('+');
+        if (plus != std::string_view::npos) {
+            offset = immOperand(lineNo, s.substr(plus + 1));
+            s = s.substr(0, plus);
+        }
+        labelOperand(lineNo, s, inst);
+        inst.imm = offset;
+    }
+
+    void instruction(std::size_t lineNo, std::string_view s) {
+        // fields are separated by whitespace and commas like MARS, a '#' starts a comment,
+        // the operands of a '+' stay together
+        s = s.substr(0, std::min(s.find('#'), s.size()));
+        std::vector<std::string_view> fields;
+        for (std::size_t begin = 0; begin < s.size();) {
+            begin = s.find_first_not_of(" \t\r,", begin);
+            if (begin == std::string_view::npos) {
+                break;
+            }
+            auto end = std::min(s.find_first_of(" \t\r,", begin), s.size());
+            if (!fields.empty() && (s[begin] == '+' || fields.back().back() == '+')) {
+                // "label + 8" is one address operand
+                auto first = static_cast<std::size_t>(fields.back().data() - s.data());
+                fields.back() = s.substr(first, end - first);
+            } else {
+                fields.push_back(s.substr(begin, end - begin));
+            }
+            begin = end;
+        }
+
+        Inst inst;
+        inst.op = op(fields[0]);
+        auto n = fields.size() - 1;
+        auto expect = [&](std::size_t count) {
+            if (n != count) {
+                throw parseError(lineNo, s, "expect " + std::to_string(count) + " operands");
+            }
+        };
+
+        switch (inst.op) {
+            case Op::addu:
+            case Op::subu:
+            case Op::mul:
+            case Op::and_:
+            case Op::or_:
+            case Op::add:
+            case Op::slt:
+            case Op::sle:
+            case Op::sge:
+            case Op::sgt:
+            case Op::seq:
+            case Op::sne:
+                expect(3);
+                inst.rd = regOperand(lineNo, fields[1]);
+                inst.rs = regOperand(lineNo, fields[2]);
+                if (!reg(fields[3], inst.rt)) {
+                    inst.hasImm = true;
+                    inst.imm = immOperand(lineNo, fields[3]);
+                }
+                break;
+            case Op::div:
+                // div $rs $rt only sets hi/lo, div $rd $rs $rt is the pseudo instruction
+                if (n == 2) {
+                    inst.rs = regOperand(lineNo, fields[1]);
+                    inst.rt = regOperand(lineNo, fields[2]);
+                } else {
+                    expect(3);
+                    inst.hasImm = true; // marks the pseudo one
+                    inst.rd = regOperand(lineNo, fields[1]);
+                    inst.rs = regOperand(lineNo, fields[2]);
+                    inst.rt = regOperand(lineNo, fields[3]);
+                }
+                break;
+            case Op::mfhi:
+                expect(1);
+                inst.rd = regOperand(lineNo, fields[1]);
+                break;
+            case Op::addi:
+            case Op::addiu:
+            case Op::subiu:
+            case Op::andi:
+            case Op::ori:
+            case Op::slti:
+            case Op::sll:
+                expect(3);
+                inst.rd = regOperand(lineNo, fields[1]);
+                inst.rs = regOperand(lineNo, fields[2]);
+                inst.hasImm = true;
+                inst.imm = immOperand(lineNo, fields[3]);
+                break;
+            case Op::move:
+                expect(2);
+                inst.rd = regOperand(lineNo, fields[1]);
+                inst.rs = regOperand(lineNo, fields[2]);
+                break;
+            case Op::li:
+                expect(2);
+                inst.rd = regOperand(lineNo, fields[1]);
+                inst.imm = immOperand(lineNo, fields[2]);
+                break;
+            case Op::la:
+            case Op::lw:
+                expect(2);
+                inst.rd = regOperand(lineNo, fields[1]);
+                addressOperand(lineNo, fields[2], inst);
+                break;
+            case Op::sw:
+                expect(2);
+                inst.rt = regOperand(lineNo, fields[1]);
+                addressOperand(lineNo, fields[2], inst);
+                break;
+            case Op::syscall:
+                expect(0);
+                break;
+            case Op::j:
+            case Op::jal:
+                expect(1);
+                labelOperand(lineNo, fields[1], inst);
+                break;
+            case Op::jr:
+                expect(1);
+                inst.rs = regOperand(lineNo, fields[1]);
+                break;
+            case Op::bgtz:
+            case Op::beqz:
+                expect(2);
+                inst.rs = regOperand(lineNo, fields[1]);
+                labelOperand(lineNo, fields[2], inst);
+                break;
+            case Op::bne:
+                if (n == 2) {
+                    inst.rs = regOperand(lineNo, fields[1]);
+                    labelOperand(lineNo, fields[2], inst);
+                } else {
+                    expect(3);
+                    inst.rs = regOperand(lineNo, fields[1]);
+                    inst.rt = regOperand(lineNo, fields[2]);
+                    labelOperand(lineNo, fields[3], inst);
+                }
+                break;
+            case Op::none:
+                throw parseError(lineNo, s, "unknown op");
+        }
+        program.text.push_back(inst);
+        program.lines.push_back(static_cast<std::uint32_t>(lineNo));
+    }
+};
+
+struct Fault {
+    std::string what;
+};
+
+class Machine {
+public:
+    Machine(const Program &program, std::istream &input, std::ostream &output) :
+        program(program),
+        data(program.data),
+        input(input),
+        output(output) {
+        regs[SP] = static_cast<std::int32_t>(SP_INIT);
+        regs[GP] = static_cast<std::int32_t>(GP_INIT);
+    }
+
+    ~Machine() {
+        flush();
+    }
+
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
+
+    Result run(const Config &config);
+
+private:
+    const Program &program;
+    std::vector<std::uint8_t> data;
+    std::vector<std::uint8_t> stack; // [STACK_END - stack.size(), STACK_END)
+    std::istream &input;
+    std::ostream &output;
+    std::string outBuffer;
+
+    std::int32_t regs[32]{};
+    std::int32_t hi{};
+    std::uint32_t pc{};
+
+    void flush() {
+        output << outBuffer;
+        outBuffer.clear();
+    }
+
+    void print(std::string_view s) {
+        outBuffer += s;
+        if (outBuffer.size() >= (1 << 16)) {
+            flush();
+        }
+    }
+
+    std::uint8_t *byte(std::uint32_t addr, std::uint32_t size) {
+        if (addr >= DATA_BASE && addr - DATA_BASE + size <= data.size()) {
+            return data.data() + (addr - DATA_BASE);
+        }
+        if (addr < STACK_END && addr >= STACK_END - MAX_STACK) {
+            auto low = STACK_END - static_cast<std::uint32_t>(stack.size());
+            if (addr < low) {
+                // grow downwards, keep the top at STACK_END
+                std::size_t need = STACK_END - addr;
+                std::size_t grown = std::max<std::size_t>({need, 2 * stack.size(), 1 << 16});
+                grown = std::min<std::size_t>(grown, MAX_STACK);
+                stack.insert(stack.begin(), grown - stack.size(), 0);
+                low = STACK_END - static_cast<std::uint32_t>(stack.size());
+            }
+            if (addr + size <= STACK_END) {
+                return stack.data() + (addr - low);
+            }
+        }
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "address 0x%08x out of range", addr);
+        throw Fault{buf};
+    }
+
+    std::int32_t load(std::uint32_t addr) {
+        if (addr % 4) {
+            throw Fault{"unaligned lw"};
+        }
+        std::int32_t value;
+        std::memcpy(&value, byte(addr, 4), 4);
+        return value;
+    }
+
+    void store(std::uint32_t addr, std::int32_t value) {
+        if (addr % 4) {
+            throw Fault{"unaligned sw"};
+        }
+        std::memcpy(byte(addr, 4), &value, 4);
+    }
+
+    // false on exit
+    bool syscall(Result &result);
+};
+
+std::uint32_t u(std::int32_t v) {
+    return static_cast<std::uint32_t>(v);
+}
+
+std::int32_t s(std::uint32_t v) {
+    return static_cast<std::int32_t>(v);
+}
+
+bool Machine::syscall(Result &result) {
+    switch (regs[V0]) {
+        case 1: {
+            char buf[16];
+            auto end = std::to_chars(buf, buf + sizeof(buf), regs[A0]).ptr;
+            print({buf, static_cast<std::size_t>(end - buf)});
+            return true;
+        }
+        case 4: {
+            for (auto addr = u(regs[A0]);; ++addr) {
+                auto c = *byte(addr, 1);
+                if (c == 0) {
+                    break;
+                }
+                outBuffer += static_cast<char>(c);
+            }
+            if (outBuffer.size() >= (1 << 16)) {
+                flush();
+            }
+            return true;
+        }
+        case 5: {
+            flush(); // interactive programs see the prompt first
+            // a failed read stores 0, so programs run past the end of input
+            std::int64_t value = 0;
+            input >> value;
+            regs[V0] = s(static_cast<std::uint32_t>(value));
+            return true;
+        }
+        case 11:
+            outBuffer += static_cast<char>(regs[A0]);
+            return true;
+        case 10:
+            return false;
+        case 17:
+            result.exitCode = regs[A0];
+            return false;
+        default:
+            throw Fault{"unknown syscall " + std::to_string(regs[V0])};
+    }
+}
+
+Result Machine::run(const Config &config) {
+    Result result;
+    auto &text = program.text;
+    auto &counts = result.counts;
+    pc = program.entry;
+    std::int64_t steps = 0;
+    auto limit = config.maxSteps > 0 ? config.maxSteps : INT64_MAX;
+    if (config.profile) {
+        result.pcCounts.resize(text.size());
+    }
+    auto pcCounts = config.profile ? result.pcCounts.data() : nullptr;
+
+    try {
+        while (pc < text.size()) {
+            if (steps == limit) {
+                result.status = Result::Status::StepLimit;
+                break;
+            }
+            ++steps;
+            if (pcCounts) {
+                ++pcCounts[pc];
+            }
+            auto &inst = text[pc++];
+            ++counts[static_cast<std::size_t>(inst.op)];
+            auto rt = inst.hasImm ? inst.imm : regs[inst.rt];
+            auto rs = regs[inst.rs];
+            std::int32_t res{};
+
+            switch (inst.op) {
+                case Op::addu:
+                case Op::add:
+                case Op::addi:
+                case Op::addiu:
+                    res = s(u(rs) + u(rt));
+                    break;
+                case Op::subu:
+                    res = s(u(rs) - u(rt));
+                    break;
+                case Op::subiu:
+                    res = s(u(rs) - u(inst.imm));
+                    break;
+                case Op::mul:
+                    res = s(u(rs) * u(rt));
+                    break;
+                case Op::div: {
+                    auto divisor = regs[inst.rt];
+                    if (divisor == 0) {
+                        // MARS leaves hi/lo alone for div, the pseudo instruction breaks
+                        if (inst.hasImm) {
+                            throw Fault{"division by zero"};
+                        }
+                        continue;
+                    }
+                    if (rs == INT32_MIN && divisor == -1) {
+                        hi = 0;
+                        res = INT32_MIN;
+                    } else {
+                        hi = rs % divisor;
+                        res = rs / divisor;
+                    }
+                    if (!inst.hasImm) {
+                        continue;
+                    }
+                    break;
+                }
+                case Op::mfhi:
+                    res = hi;
+                    break;
+                case Op::and_:
+                case Op::andi:
+                    res = rs & rt;
+                    break;
+                case Op::or_:
+                case Op::ori:
+                    res = rs | rt;
+                    break;
+                case Op::slt:
+                case Op::slti:
+                    res = rs < rt;
+                    break;
+                case Op::sle:
+                    res = rs <= rt;
+                    break;
+                case Op::sge:
+                    res = rs >= rt;
+                    break;
+                case Op::sgt:
+                    res = rs > rt;
+                    break;
+                case Op::seq:
+                    res = rs == rt;
+                    break;
+                case Op::sne:
+                    res = rs != rt;
+                    break;
+                case Op::sll:
+                    res = s(u(rs) << (inst.imm & 31));
+                    break;
+                case Op::move:
+                    res = rs;
+                    break;
+                case Op::li:
+                    res = inst.imm;
+                    break;
+                case Op::la:
+                    res = s(u(rs) + u(inst.imm));
+                    break;
+                case Op::lw:
+                    res = load(u(rs) + u(inst.imm));
+                    break;
+                case Op::sw:
+                    store(u(rs) + u(inst.imm), regs[inst.rt]);
+                    continue;
+                case Op::syscall:
+                    if (!syscall(result)) {
+                        pc = static_cast<std::uint32_t>(text.size());
+                    }
+                    continue;
+                case Op::j:
+                    pc = u(inst.imm);
+                    continue;
+                case Op::jal:
+                    regs[RA] = s(pc);
+                    pc = u(inst.imm);
+                    continue;
+                case Op::jr:
+                    pc = u(rs);
+                    continue;
+                case Op::bgtz:
+                    if (rs > 0) {
+                        pc = u(inst.imm);
+                    }
+                    continue;
+                case Op::beqz:
+                    if (rs == 0) {
+                        pc = u(inst.imm);
+                    }
+                    continue;
+                case Op::bne:
+                    if (rs != regs[inst.rt]) {
+                        pc = u(inst.imm);
+                    }
+                    continue;
+                case Op::none:
+                    continue;
+            }
+            if (inst.rd != 0) {
+                regs[inst.rd] = res;
+            }
+        }
+    } catch (const Fault &fault) {
+        result.status = Result::Status::Fault;
+        std::string where = "pc " + std::to_string(pc - 1);
+        // name the function or block by the nearest label before pc
+        for (auto p = pc; p-- > 0;) {
+            if (p < program.textLabels.size() && !program.textLabels[p].empty()) {
+                where += " (after " + program.textLabels[p] + ")";
+                break;
+            }
+        }
+        result.fault = fault.what + " at " + where;
+    }
+
+    result.steps = steps;
+    for (std::size_t i = 0; i < OPS; ++i) {
+        result.cost += static_cast<double>(counts[i]) * config.weights.of[i];
+    }
+    return result;
+}
+} // namespace
+
+Weights Weights::defaults() {
+    Weights w;
+    w.of.fill(1);
+    w.of[static_cast<std::size_t>(Op::div)] = 50;
+    w.of[static_cast<std::size_t>(Op::mul)] = 3;
+    w.of[static_cast<std::size_t>(Op::lw)] = 2;
+    w.of[static_cast<std::size_t>(Op::sw)] = 2;
+    for (auto op: {Op::j, Op::jal, Op::jr, Op::bgtz, Op::beqz, Op::bne}) {
+        w.of[static_cast<std::size_t>(op)] = 1.2;
+    }
+    return w;
+}
+
+Weights Weights::read(const std::string &file) {
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("Reading " + file + " fails!");
+    }
+    auto w = defaults();
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string name;
+        double weight;
+        if (!(fields >> name)) {
+            continue;
+        }
+        if (!(fields >> weight)) {
+            throw std::runtime_error(file + ": bad weight of " + name);
+        }
+        std::size_t i = 1;
+        while (i < OPS && MIPS::opName(static_cast<Op>(i)) != name) {
+            ++i;
+        }
+        if (i == OPS) {
+            throw std::runtime_error(file + ": unknown op " + name);
+        }
+        w.of[i] = weight;
+    }
+    return w;
+}
+
+Program Program::parse(std::string_view assembly) {
+    return Parser().parse(assembly);
+}
+
+Program Program::read(const std::string &file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Reading " + file + " fails!");
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return parse(text.str());
+}
+
+Result Sim::run(const Program &program, std::istream &input, std::ostream &output, const Config &config) {
+    return Machine(program, input, output).run(config);
+}
+
+void Sim::report(std::ostream &out, const Result &result, const Weights &weights) {
+    std::ostringstream res;
+    switch (result.status) {
+        case Result::Status::Exited:
+            res << "exited with " << result.exitCode << '\n';
+            break;
+        case Result::Status::StepLimit:
+            res << "stopped at the step limit\n";
+            break;
+        case Result::Status::Fault:
+            res << "fault: " << result.fault << '\n';
+            break;
+    }
+    res << "steps " << result.steps << ", cost " << static_cast<std::int64_t>(result.cost + 0.5) << '\n';
+    for (std::size_t i = 1; i < OPS; ++i) {
+        if (result.counts[i] == 0) {
+            continue;
+        }
+        char buf[96];
+        std::snprintf(buf, sizeof(buf), "%-8s %12lld x %-5g = %.0f\n",
+                      std::string(MIPS::opName(static_cast<Op>(i))).c_str(),
+                      static_cast<long long>(result.counts[i]), weights.of[i],
+                      static_cast<double>(result.counts[i]) * weights.of[i]);
+        res << buf;
+    }
+    out << res.str();
+}
+
+void Sim::annotate(std::ostream &out, std::string_view assembly, const Program &program,
+                   const Result &result, const Weights &weights, const Rows &rows) {
+    auto cost = [&](std::size_t pc) {
+        return static_cast<double>(result.pcCounts[pc]) * weights.of[static_cast<std::size_t>(program.text[pc].op)];
+    };
+
+    std::string res;
+    char buf[128];
+    std::size_t pc = 0;
+    std::uint32_t lineNo = 0;
+    for (std::size_t begin = 0; begin < assembly.size();) {
+        auto end = std::min(assembly.find('\n', begin), assembly.size());
+        auto line = assembly.substr(begin, end - begin);
+        begin = end + 1;
+        ++lineNo;
+
+        if (pc < program.text.size() && program.lines[pc] == lineNo) {
+            std::snprintf(buf, sizeof(buf), "%12lld %14.0f  ", static_cast<long long>(result.pcCounts[pc]), cost(pc));
+            res += buf;
+            ++pc;
+        } else {
+            res.append(29, ' ');
+        }
+        res += line;
+        res += '\n';
+        if (res.size() >= (1 << 16)) {
+            out << res;
+            res.clear();
+        }
+    }
+
+    // the block of a label runs to the next label
+    struct Block {
+        std::string_view label;
+        std::int64_t entries;
+        double cost;
+    };
+    std::vector<Block> blocks;
+    double total = 0;
+    for (pc = 0; pc < program.text.size(); ++pc) {
+        if (!program.textLabels[pc].empty() || blocks.empty()) {
+            blocks.push_back({program.textLabels[pc], result.pcCounts[pc], 0});
+        }
+        blocks.back().cost += cost(pc);
+        total += cost(pc);
+    }
+    std::stable_sort(blocks.begin(), blocks.end(), [](const Block &a, const Block &b) { return a.cost > b.cost; });
+
+    res += "\n#### hot blocks ####\n";
+    std::snprintf(buf, sizeof(buf), "%-32s %6s %12s %14s %7s\n", "label", "row", "entries", "cost", "%");
+    res += buf;
+    for (auto &block: blocks) {
+        if (block.cost == 0) {
+            break;
+        }
+        auto row = rows.find(std::string(block.label));
+        auto name = block.label.empty() ? std::string("(no label)") : std::string(block.label);
+        std::snprintf(buf, sizeof(buf), " %6s %12lld %14.0f %6.2f%%\n",
+                      row == rows.end() || row->second == 0 ? "?" : std::to_string(row->second).c_str(),
+                      static_cast<long long>(block.entries), block.cost, total > 0 ? 100 * block.cost / total : 0.0);
+        res += (name.size() < 32 ? name + std::string(32 - name.size(), ' ') : name) + buf;
+    }
+    out << res;
+}
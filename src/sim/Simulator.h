@@ -0,0 +1,103 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_SIMULATOR_H
+#define COMPILER_SIMULATOR_H
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "backend/Instruction.h"
+
+// Simulator of the MIPS subset written by MIPS::genMIPS, so generated code runs without MARS.
+// It takes the text of mips.txt: .data with .word .space .asciiz, .text with the ops of MIPS::Op,
+// and the syscalls for getint and printing. Memory layout and pseudo instructions follow MARS.
+namespace Sim {
+constexpr std::size_t OPS = static_cast<std::size_t>(MIPS::Op::slti) + 1;
+
+// cost of one executed instruction, per MIPS::Op
+struct Weights {
+    std::array<double, OPS> of{};
+
+    // div 50, mul 3, lw/sw 2, jumps and branches 1.2, others 1
+    static Weights defaults();
+
+    // defaults changed by lines "<op> <weight>", '#' starts a comment
+    // throw std::runtime_error on a bad file or an unknown op
+    static Weights read(const std::string &file);
+};
+
+// one decoded instruction
+struct Inst {
+    MIPS::Op op{};
+    std::uint8_t rd{}; // written register
+    std::uint8_t rs{};
+    std::uint8_t rt{};
+    bool hasImm{};     // the last operand is imm instead of rt
+    std::int32_t imm{}; // immediate, address offset, or target pc
+};
+
+// decoded mips.txt
+struct Program {
+    std::vector<Inst> text;
+    std::vector<std::uint8_t> data; // from DATA_BASE
+    std::unordered_map<std::string, std::uint32_t> labels; // text labels to pc, data labels to address
+    std::vector<std::string> textLabels; // text labels by pc, "" if none
+    std::vector<std::uint32_t> lines; // line of each instruction in the assembly, from 1
+    std::uint32_t entry{};
+
+    // throw std::runtime_error on what genMIPS never writes
+    static Program parse(std::string_view assembly);
+    static Program read(const std::string &file);
+};
+
+struct Config {
+    Weights weights = Weights::defaults();
+    std::int64_t maxSteps{}; // stop after that many instructions, 0 is no limit
+    bool profile{}; // count each instruction in Result::pcCounts
+};
+
+struct Result {
+    enum class Status {
+        Exited,    // syscall 10/17 or ran off the end of .text
+        StepLimit,
+        Fault,     // bad address, division by zero, bad syscall ...
+    };
+
+    Status status{Status::Exited};
+    std::string fault; // what and where, for Status::Fault
+    std::int32_t exitCode{};
+
+    std::int64_t steps{};
+    double cost{};
+    std::array<std::int64_t, OPS> counts{};
+    std::vector<std::int64_t> pcCounts; // executions of each instruction, with Config::profile
+};
+
+// the text of a .asciiz string "a\nb" with the quotes
+std::string unescape(std::string_view quoted);
+
+// run program from its entry, getint reads integers from input (0 once it runs out), prints go to output
+Result run(const Program &program, std::istream &input, std::ostream &output, const Config &config = {});
+
+// steps, cost and the count and cost of each op executed
+void report(std::ostream &out, const Result &result, const Weights &weights);
+
+// source row of each IR::BasicBlock label, from the compilation that wrote the assembly
+using Rows = std::unordered_map<std::string, int>;
+
+// the assembly with the count and cost of each instruction before it,
+// then the labels in order of the cost of the instructions up to the next label
+// result must come from a run of program with Config::profile
+void annotate(std::ostream &out, std::string_view assembly, const Program &program,
+              const Result &result, const Weights &weights, const Rows &rows = {});
+} // namespace Sim
+
+#endif
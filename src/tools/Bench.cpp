@@ -0,0 +1,188 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "middle/PassManager.h"
+#include "tools/Driver.h"
+#include "tools/Interpret.h"
+#include "tools/MappedFile.h"
+#include "tools/ThreadPool.h"
+
+namespace {
+std::string readFile(const std::string &file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Reading " + file + " fails!");
+    }
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+std::string padLeft(const std::string &text, std::size_t width) {
+    return std::string(width > text.size() ? width - text.size() : 1, ' ') + text;
+}
+
+std::vector<Bench::Program> readDir(const std::string &dir) {
+    namespace fs = std::filesystem;
+    std::vector<Bench::Program> programs;
+    for (auto &entry: fs::directory_iterator(dir)) {
+        auto source = entry.path().string() + "/";
+        if (fs::exists(source + "testfile.txt")) {
+            programs.push_back({entry.path().filename().string(), source + "testfile.txt",
+                                fs::exists(source + "input.txt") ? readFile(source + "input.txt") : "",
+                                readFile(source + "output.txt")});
+        }
+    }
+    std::sort(programs.begin(), programs.end(),
+              [](const Bench::Program &a, const Bench::Program &b) { return a.name < b.name; });
+    if (programs.empty()) {
+        throw std::runtime_error("no " + dir + "/<name>/testfile.txt");
+    }
+    return programs;
+}
+
+Bench::Program generate(const Bench::Config &config, std::uint32_t seed) {
+    auto generator = config.generator;
+    generator.seed = seed;
+    auto name = "gen" + std::to_string(seed);
+    auto dir = config.outDir + name + "/";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir + "testfile.txt") << Generator::generate(generator);
+
+    auto [result, output] = Interpret::stage(dir + "testfile.txt", Opt::level(0), "", {config.sim.maxSteps});
+    if (result.status != Interp::Result::Status::Exited) {
+        throw std::runtime_error(dir + "testfile.txt: the unoptimized IR does not exit");
+    }
+    return {name, dir + "testfile.txt", "", output};
+}
+
+// -O0 to -O<MAX_LEVEL>, then the --passes specs as P1, P2 ...
+std::vector<std::pair<std::string, Opt::Config>> benchLevels(const Bench::Config &config) {
+    std::vector<std::pair<std::string, Opt::Config>> res;
+    for (int level = 0; level <= Opt::MAX_LEVEL; ++level) {
+        res.emplace_back("O" + std::to_string(level), Opt::level(level));
+    }
+    for (std::size_t i = 0; i < config.passes.size(); ++i) {
+        res.emplace_back("P" + std::to_string(i + 1), Opt::parse(config.passes[i]));
+    }
+    return res;
+}
+} // namespace
+
+std::vector<Bench::Program> Bench::programs(const Config &config) {
+    std::vector<Program> res;
+    if (!config.dir.empty()) {
+        res = readDir(config.dir);
+    }
+    for (int i = 0; i < config.generated; ++i) {
+        res.push_back(generate(config, config.generator.seed + i));
+    }
+    return res;
+}
+
+std::string Bench::join(const std::vector<std::string> &names) {
+    std::string res;
+    for (auto &name: names) {
+        res += (res.empty() ? "" : ",") + name;
+    }
+    return res;
+}
+
+int Bench::run(const Config &config) {
+    namespace fs = std::filesystem;
+    auto programs = Bench::programs(config);
+    auto levels = benchLevels(config);
+    struct Total {
+        std::int64_t steps{};
+        double cost{};
+        std::size_t size{};
+    };
+    std::vector<Total> totals(levels.size());
+    bool failed = false;
+
+    auto line = [](const std::string &name, const std::string &level, const std::string &result,
+                   const std::string &steps, const std::string &cost, const std::string &ratio, const std::string &size) {
+        auto head = name;
+        head.resize(std::max<std::size_t>(head.size() + 1, 12), ' ');
+        head += level;
+        head.resize(std::max<std::size_t>(head.size() + 1, 22), ' ');
+        head += result;
+        head.resize(std::max<std::size_t>(head.size(), 36), ' ');
+        return head + padLeft(steps, 14) + padLeft(cost, 16) + padLeft(ratio, 9) + padLeft(size, 8) + '\n';
+    };
+    std::cout << line("program", "level", "result", "steps", "cost", "cost%", "size");
+
+    ThreadPool pool;
+    for (auto &[name, file, input, expected]: programs) {
+        double baseline = 0;
+        for (std::size_t l = 0; l < levels.size(); ++l) {
+            auto &[level, optimize] = levels[l];
+            auto out = config.outDir + name + "/" + level + "/";
+            fs::create_directories(out);
+            Driver::Options compileOptions;
+            compileOptions.optimize = &optimize;
+            Driver::compile(file, "", out + "error.txt", out + "ir.txt", out + "mips.txt", pool, compileOptions);
+
+            MappedFile assembly(out + "mips.txt");
+            if (assembly.view().empty()) {
+                std::cout << line(name, level, "compile error", "", "", "", "");
+                failed = true;
+                continue;
+            }
+            auto program = Sim::Program::parse(assembly.view());
+            std::istringstream in(input);
+            std::ostringstream output;
+            auto result = Sim::run(program, in, output, config.sim);
+
+            std::string verdict = "ok";
+            if (result.status == Sim::Result::Status::StepLimit) {
+                verdict = "step limit";
+            } else if (result.status == Sim::Result::Status::Fault) {
+                verdict = "fault";
+                std::cerr << name + " " + level + ": " + result.fault + "\n";
+            } else if (output.str() != expected) {
+                verdict = "wrong output";
+            }
+            failed |= verdict != "ok";
+
+            if (l == 0) {
+                baseline = result.cost;
+            }
+            char ratio[16];
+            std::snprintf(ratio, sizeof(ratio), "%.1f", baseline > 0 ? result.cost * 100 / baseline : 0.0);
+            std::cout << line(name, level, verdict, std::to_string(result.steps),
+                              std::to_string(std::llround(result.cost)), ratio,
+                              std::to_string(program.text.size()));
+            totals[l].steps += result.steps;
+            totals[l].cost += result.cost;
+            totals[l].size += program.text.size();
+        }
+    }
+
+    for (std::size_t l = 0; l < levels.size(); ++l) {
+        char ratio[16];
+        std::snprintf(ratio, sizeof(ratio), "%.1f", totals[0].cost > 0 ? totals[l].cost * 100 / totals[0].cost : 0.0);
+        std::cout << line("total", levels[l].first, "", std::to_string(totals[l].steps),
+                          std::to_string(std::llround(totals[l].cost)), ratio,
+                          std::to_string(totals[l].size));
+    }
+    std::cout << '\n';
+    for (auto &[level, optimize]: levels) {
+        std::cout << level + ": --passes \"" + join(Opt::names(optimize)) + "\"\n";
+    }
+    std::cout.flush();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_BENCH_H
+#define COMPILER_BENCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sim/Simulator.h"
+#include "tools/Generator.h"
+
+// "--bench": the weighted cost and code size of the bench programs at each optimization level on Sim.
+// Its programs and Config are shared with Check.
+namespace Bench {
+struct Config {
+    std::string dir;
+    std::string outDir;
+    Sim::Config sim;
+    // programs of Generator with seeds from generator.seed on
+    int generated{};
+    Generator::Config generator;
+    // Opt::parse specs to compare besides the levels
+    std::vector<std::string> passes;
+};
+
+struct Program {
+    std::string name;
+    std::string file;
+    std::string input;
+    std::string expected;
+};
+
+// <dir>/<name>/testfile.txt with input.txt (none if missing) and output.txt, the programs of config.dir if any,
+// then config.generated ones written to <outDir>/gen<seed>/testfile.txt without input,
+// the output of their unoptimized IR is expected
+std::vector<Program> programs(const Config &config);
+
+// names separated by ',' as Opt::parse reads them
+std::string join(const std::vector<std::string> &names);
+
+// every program is compiled at -O0 to -O<MAX_LEVEL>, then the --passes specs as P1, P2 ... into <outDir>/<name>/<level>/,
+// then run on the simulator and checked against its expected output
+// prints the weighted cost and the code size of each, the first level is the baseline of the "cost" column
+// fails if any program compiles or prints wrong
+int run(const Config &config);
+} // namespace Bench
+
+#endif
@@ -0,0 +1,153 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Check.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "middle/PassManager.h"
+#include "tools/Driver.h"
+#include "tools/MappedFile.h"
+#include "tools/ThreadPool.h"
+
+namespace {
+// compile program with the optimizations passes into dir, run it on the simulator
+// "ok" if it exits printing the expected output, else what went wrong
+std::string checkRun(const Bench::Program &program, const std::vector<std::string> &passes, const std::string &dir,
+                     const Sim::Config &config, ThreadPool &pool, Sim::Result &result) {
+    auto optimize = Opt::parse(Bench::join(passes));
+    std::filesystem::create_directories(dir);
+    Driver::Options compileOptions;
+    compileOptions.optimize = &optimize;
+    Driver::compile(program.file, "", dir + "error.txt", dir + "ir.txt", dir + "mips.txt", pool, compileOptions);
+
+    MappedFile assembly(dir + "mips.txt");
+    if (assembly.view().empty()) {
+        return "compile error";
+    }
+    std::istringstream in(program.input);
+    std::ostringstream output;
+    result = Sim::run(Sim::Program::parse(assembly.view()), in, output, config);
+    if (result.status == Sim::Result::Status::StepLimit) {
+        return "step limit";
+    }
+    if (result.status == Sim::Result::Status::Fault) {
+        return "fault: " + result.fault;
+    }
+    return output.str() == program.expected ? "ok" : "wrong output";
+}
+} // namespace
+
+int Check::run(const Bench::Config &config) {
+    auto programs = Bench::programs(config);
+
+    std::vector<std::string> passes;
+    for (auto phase: {Opt::Phase::GenIR, Opt::Phase::IR, Opt::Phase::MIPS}) {
+        auto names = Opt::passNames(phase);
+        passes.insert(passes.end(), names.begin(), names.end());
+    }
+    auto defaults = Opt::level(Opt::DEFAULT_LEVEL);
+    std::vector<std::pair<std::string, std::vector<std::string>>> runs{
+            {"none", {}},
+            {"default", Opt::names(defaults)},
+    };
+    for (auto &pass: passes) {
+        runs.emplace_back("only " + pass, std::vector<std::string>{pass});
+        auto toggled = defaults;
+        bool on = !Opt::has(defaults, pass);
+        Opt::enable(toggled, pass, on);
+        runs.emplace_back((on ? "default +" : "default -") + pass, Opt::names(toggled));
+    }
+    for (auto &spec: config.passes) {
+        runs.emplace_back(spec, Opt::names(Opt::parse(spec)));
+    }
+
+    auto line = [](const std::string &name, const std::string &run, const std::string &verdict, const std::string &culprit) {
+        auto res = name;
+        res.resize(std::max<std::size_t>(res.size() + 1, 12), ' ');
+        res += run;
+        res.resize(std::max<std::size_t>(res.size() + 1, 46), ' ');
+        res += verdict;
+        res.resize(std::max<std::size_t>(res.size() + 1, 62), ' ');
+        return res + culprit + '\n';
+    };
+    std::cout << line("program", "passes", "result", "first offending pass");
+
+    ThreadPool pool;
+    std::map<std::string, int> offences;
+    bool failed = false;
+    for (auto &program: programs) {
+        auto sim = config.sim;
+        // runs of the same passes are shared by the table and the bisections,
+        // in <outDir>/<name>/<passes joined by '+', "none" for no pass>/
+        std::map<std::vector<std::string>, std::string> verdicts;
+        Sim::Result none;
+        auto verdictOf = [&](const std::vector<std::string> &enabled) -> std::string {
+            auto it = verdicts.find(enabled);
+            if (it == verdicts.end()) {
+                auto dir = Bench::join(enabled);
+                std::replace(dir.begin(), dir.end(), ',', '+');
+                dir = config.outDir + program.name + "/" + (dir.empty() ? "none" : dir) + "/";
+                Sim::Result result;
+                it = verdicts.emplace(enabled, checkRun(program, enabled, dir, sim, pool, result)).first;
+                if (enabled.empty()) {
+                    none = result;
+                }
+            }
+            return it->second;
+        };
+
+        auto noneVerdict = verdictOf({});
+        // passes only remove instructions, so a miscompiled loop stops long before the limit
+        if (noneVerdict == "ok") {
+            sim.maxSteps = std::min(sim.maxSteps, std::max<std::int64_t>(4 * none.steps, 1'000'000));
+        }
+
+        bool programFailed = false;
+        for (auto &[run, enabled]: runs) {
+            auto verdict = verdictOf(enabled);
+            if (verdict == "ok") {
+                continue;
+            }
+            programFailed = true;
+            std::string culprit = "(unoptimized)";
+            if (noneVerdict == "ok") {
+                // the first `good` optimizations of enabled are fine, the first `bad` break the program
+                std::size_t good = 0;
+                std::size_t bad = enabled.size();
+                while (bad - good > 1) {
+                    auto mid = (good + bad) / 2;
+                    std::vector<std::string> prefix(enabled.begin(), enabled.begin() + static_cast<std::ptrdiff_t>(mid));
+                    (verdictOf(prefix) == "ok" ? good : bad) = mid;
+                }
+                culprit = enabled[bad - 1];
+                ++offences[culprit];
+            }
+
+            failed |= std::all_of(enabled.begin(), enabled.end(),
+                                  [&](const std::string &pass) { return Opt::has(defaults, pass); });
+            std::cout << line(program.name, run, verdict, culprit);
+        }
+        if (!programFailed) {
+            std::cout << line(program.name, std::to_string(runs.size()) + " runs", "ok", "");
+        }
+        std::cout.flush();
+    }
+
+    std::cout << "\n" << line("", "pass", "in -O2", "offences");
+    for (auto &pass: passes) {
+        std::cout << line("", pass, Opt::has(defaults, pass) ? "yes" : "no", std::to_string(offences[pass]));
+    }
+    std::cout.flush();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_CHECK_H
+#define COMPILER_CHECK_H
+
+#include "tools/Bench.h"
+
+// "--check": differential check of the optimizations on the programs of Bench.
+namespace Check {
+// every program is compiled with none, with those of -O2, with each alone, with each toggled from -O2
+// and with each --passes spec, then run on the simulator with its input and compared with its expected output
+// a mismatch is bisected: the optimizations of that run are turned on one by one in their order
+// until the output breaks, the last one is the first offending pass
+// fails if a program breaks with only optimizations of -O2
+int run(const Bench::Config &config);
+} // namespace Check
+
+#endif
@@ -0,0 +1,185 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Driver.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "AST/CompUnit.h"
+#include "Context.h"
+#include "backend/MIPS.h"
+#include "errorHandler/Error.h"
+
+namespace {
+void recordBlocks(const IR::Function &func, Profile::Blocks *blocks) {
+    if (blocks) {
+        Profile::record(func, *blocks);
+    }
+}
+
+void compileModule(const Opt::Pipeline &pipeline, Profile::Blocks *blocks) {
+    auto compUnit = CompUnit::parse();
+    if (Error::hasError()) {
+        return;
+    }
+    auto module = compUnit->genIR();
+    pipeline.run(*module);
+    recordBlocks(module->getMainFunction(), blocks);
+    for (auto &func: module->getFunctions()) {
+        recordBlocks(*func, blocks);
+    }
+    auto &output = Context::cur().output;
+    if (output.ir) {
+        Stats::Timer timer("outputIR");
+        module->outputIR();
+    }
+    if (output.mips) {
+        MIPS::genMIPS(*module);
+    }
+}
+
+void compileStream(const Opt::Pipeline &pipeline, Profile::Blocks *blocks) {
+    auto &output = Context::cur().output;
+    CompUnit::stream(
+            [&](IR::Module &globals) {
+                if (output.ir) {
+                    Stats::Timer timer("outputIR");
+                    globals.outputGlobVarsIR();
+                }
+                if (output.mips) {
+                    MIPS::genGlobals(globals);
+                }
+            },
+            [&](IR::Function &func, bool isMain) {
+                pipeline.run(func);
+                recordBlocks(func, blocks);
+                if (output.ir) {
+                    Stats::Timer timer("outputIR");
+                    func.outputIR();
+                }
+                if (output.mips) {
+                    MIPS::genStreamFunction(func, isMain);
+                }
+            });
+}
+
+// open file for a File sink, leave it closed otherwise
+void openFileSink(std::ofstream &stream, unsigned sinks, const std::string &file) {
+    if (sinks & Output::File) {
+        stream.open(file);
+    }
+}
+} // namespace
+
+void Driver::compile(const std::string &inFile,
+                     const std::string &outFile,
+                     const std::string &errorFile,
+                     const std::string &IRFile,
+                     const std::string &mipsFile,
+                     ThreadPool &pool,
+                     const Options &options) {
+    Context context;
+    Context::Scope scope(context);
+    context.pool = &pool;
+    context.stats.format = options.report;
+    context.stats.trace = options.trace;
+    context.mips.profile = options.profile;
+    auto optimize = options.optimize ? *options.optimize : Opt::level(Opt::DEFAULT_LEVEL);
+    auto &output = context.output = options.output;
+    context.exp.foldOffsets = optimize.foldOffsets;
+    context.mips.peepholes = optimize.peepholes;
+
+    {
+        Stats::Timer timer("total", inFile);
+        Lexer::init(inFile, outFile);
+        openFileSink(context.error.errorFileStream, output.error, errorFile);
+        openFileSink(context.ir.IRFileStream, output.ir, IRFile);
+        openFileSink(context.mips.mipsFileStream, output.mips, mipsFile);
+        if (output.mips & Output::File) {
+            context.mips.emitter.addSink(context.mips.mipsFileStream);
+        }
+        if (output.mips & Output::Stdout) {
+            context.mips.emitter.addSink(std::cout);
+        }
+
+        if (options.stream) {
+            compileStream(optimize.pipeline, options.blocks);
+        } else {
+            compileModule(optimize.pipeline, options.blocks);
+        }
+
+        // functions before the error are already written in streaming mode, drop them like the whole program mode
+        if (options.stream && Error::hasError()) {
+            context.ir.IRFileStream.close();
+            openFileSink(context.ir.IRFileStream, output.ir, IRFile);
+            context.mips.emitter.discard();
+            context.mips.mipsFileStream.close();
+            openFileSink(context.mips.mipsFileStream, output.mips, mipsFile);
+        }
+
+        Stats::Timer flush("flush");
+        context.mips.emitter.flush();
+    }
+
+    Stats::report(std::cerr, inFile);
+}
+
+std::string Driver::dirOf(const std::string &path) {
+    auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+std::vector<Driver::Job> Driver::readManifest(const std::string &manifest) {
+    std::ifstream in(manifest);
+    if (!in) {
+        throw std::runtime_error("Reading " + manifest + " fails!");
+    }
+
+    std::vector<Job> jobs;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        Job job;
+        if (!(fields >> job.inFile) || job.inFile[0] == '#') {
+            continue;
+        }
+        if (fields >> job.outDir) {
+            if (job.outDir.back() != '/' && job.outDir.back() != '\\') {
+                job.outDir += '/';
+            }
+        } else {
+            job.outDir = dirOf(job.inFile);
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+int Driver::compileAll(const std::vector<Job> &jobs, unsigned threads, const Options &options) {
+    ThreadPool pool(threads);
+    std::atomic<int> failures{0};
+
+    pool.parallelFor(jobs.size(), [&](std::size_t i) {
+        const auto &job = jobs[i];
+        try {
+            compile(job.inFile,
+                    job.outDir + "output.txt",
+                    job.outDir + "error.txt",
+                    job.outDir + "ir.txt",
+                    job.outDir + "mips.txt",
+                    pool, options);
+        } catch (const std::exception &e) {
+            ++failures;
+            std::cerr << job.inFile + ": " + e.what() + "\n";
+        }
+    });
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
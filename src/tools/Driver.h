@@ -0,0 +1,61 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_DRIVER_H
+#define COMPILER_DRIVER_H
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "middle/PassManager.h"
+#include "middle/Profile.h"
+#include "tools/Stats.h"
+#include "tools/ThreadPool.h"
+
+// One compilation from a source file to its outputs, and the batch mode compiling many of them on a ThreadPool.
+// Every harness compiles through compile(), so they all see the same pipeline as the command line.
+namespace Driver {
+struct Options {
+    // compile function by function with bounded memory, see CompUnit::stream
+    bool stream{false};
+    // print Stats::report of each compilation to stderr
+    Stats::Format report{Stats::Format::None};
+    // spans of every compilation, written by main
+    Stats::Trace *trace{};
+    // collects the function and source row of the labels in mips.txt if not nullptr
+    Profile::Blocks *blocks{};
+    // block frequencies from "--profile", see MIPS::State::profile
+    const Profile::Frequencies *profile{};
+    // optimizations, Opt::level(Opt::DEFAULT_LEVEL) if nullptr
+    const Opt::Config *optimize{};
+    // artifacts to write, "--emit"
+    Output::Config output;
+};
+
+void compile(const std::string &inFile,
+             const std::string &outFile,
+             const std::string &errorFile,
+             const std::string &IRFile,
+             const std::string &mipsFile,
+             ThreadPool &pool,
+             const Options &options = {});
+
+struct Job {
+    std::string inFile;
+    std::string outDir;
+};
+
+// "dir/testfile.txt" -> "dir/", "testfile.txt" -> ""
+std::string dirOf(const std::string &path);
+
+// one job per line: "<inFile> [outDir]", outDir defaults to the directory of inFile
+// blank lines and lines starting with '#' are skipped
+std::vector<Job> readManifest(const std::string &manifest);
+
+// compile every job as if the compiler were run alone in its outDir
+int compileAll(const std::vector<Job> &jobs, unsigned threads, const Options &options);
+} // namespace Driver
+
+#endif
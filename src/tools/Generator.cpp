@@ -0,0 +1,596 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Generator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace Generator;
+
+namespace {
+// estimated statements run by one call of a function and by main, see Builder::work
+constexpr std::int64_t FUNCTION_BUDGET = 2'000;
+constexpr std::int64_t MAIN_BUDGET = 100'000;
+
+// most trips of a loop
+constexpr int TRIPS = 5;
+
+struct Var {
+    std::string name;
+    // lengths; an array parameter has the least length of the arrays it may be given
+    std::vector<int> dims;
+    bool constant{};
+    bool assignable{true}; // loop counters are not
+    bool local{};          // assigning it is no side effect of the function
+};
+
+struct Func {
+    std::string name;
+    bool returnsInt{};
+    std::vector<std::vector<int>> params; // dims of each, empty for int
+    std::int64_t work{};
+    bool called{};
+    // no side effect: assigns no global or array parameter, calls no printf, getint or function with one
+    bool pure{};
+};
+
+class Builder {
+public:
+    explicit Builder(const Config &config) :
+        config(config),
+        random(config.seed) {}
+
+    std::string build();
+
+private:
+    const Config &config;
+    std::mt19937 random;
+
+    std::string out;
+    std::size_t lines{};
+    int uid{};
+
+    std::vector<Var> globals;
+    std::vector<Func> funcs;
+
+    // the function being generated
+    std::vector<Var> scope; // globals, parameters, then locals, innermost last
+    bool returnsInt{};
+    bool pure{};
+    std::int64_t work{};    // statements run so far, loops count by their trips
+    std::int64_t budget{};
+    std::int64_t trips{1};  // product of the trips of the enclosing loops
+    int depth{};
+    int loops{};
+
+    // std::uniform_int_distribution differs between standard libraries, mt19937 does not
+    int below(int n) {
+        return n <= 1 ? 0 : static_cast<int>(random() % static_cast<std::uint32_t>(n));
+    }
+
+    bool chance(int percent) {
+        return below(100) < percent;
+    }
+
+    std::string fresh(const char *prefix) {
+        return prefix + std::to_string(++uid);
+    }
+
+    std::string number(int n) {
+        return std::to_string(below(n));
+    }
+
+    void line(int indent, const std::string &text) {
+        out.append(4 * static_cast<std::size_t>(indent), ' ');
+        out += text;
+        out += '\n';
+        ++lines;
+    }
+
+    std::vector<const Var *> pick(bool (*fits)(const Var &)) const {
+        std::vector<const Var *> res;
+        for (auto &v: scope) {
+            if (fits(v)) {
+                res.push_back(&v);
+            }
+        }
+        return res;
+    }
+
+    template<typename T>
+    const T &any(const std::vector<T> &from) {
+        return from[below(static_cast<int>(from.size()))];
+    }
+
+    std::string dims(const std::vector<int> &lengths) const;
+    std::string init(const std::vector<int> &lengths, bool constant, int d);
+
+    std::string index(int length, int d);
+    std::string element(const Var &v, int d);
+    std::string atom(int d);
+    std::string unary(int d);
+    std::string mul(int d);
+    std::string exp(int d = 0);
+    std::string eq();
+    std::string cond();
+    std::string call(int d, bool inExp);
+    std::string arg(const std::vector<int> &param, int d);
+
+    void decl(int indent, bool global);
+    void block(int indent);
+    void statement(int indent);
+    void forStmt(int indent);
+    void function();
+    void mainFunction();
+};
+
+// "[2][3]"
+std::string Builder::dims(const std::vector<int> &lengths) const {
+    std::string res;
+    for (auto length: lengths) {
+        res += "[" + std::to_string(length) + "]";
+    }
+    return res;
+}
+
+// "{1, 2}" or "{{1, 2}, {3, 4}}", constant elements are numbers
+std::string Builder::init(const std::vector<int> &lengths, bool constant, int d) {
+    std::string res = "{";
+    for (int i = 0; i < lengths[0]; ++i) {
+        res += i ? ", " : "";
+        if (lengths.size() == 2) {
+            res += init({lengths[1]}, constant, d);
+        } else {
+            res += constant ? number(20) : exp(d);
+        }
+    }
+    return res + "}";
+}
+
+// always in [0, length)
+std::string Builder::index(int length, int d) {
+    if (length == 1 || chance(50)) {
+        return number(length);
+    }
+    auto n = std::to_string(length);
+    return "((" + exp(d) + ") % " + n + " + " + n + ") % " + n;
+}
+
+std::string Builder::element(const Var &v, int d) {
+    auto res = v.name;
+    for (auto length: v.dims) {
+        res += "[" + index(length, d + 1) + "]";
+    }
+    return res;
+}
+
+// LVal, Number, PareExp, FuncCall
+std::string Builder::atom(int d) {
+    auto r = below(100);
+    if (d >= config.expressionDepth || r < 35) {
+        auto scalars = pick([](const Var &v) { return v.dims.empty(); });
+        return !scalars.empty() && chance(65) ? any(scalars)->name : number(40);
+    }
+    if (r < 55) {
+        auto arrays = pick([](const Var &v) { return !v.dims.empty(); });
+        if (!arrays.empty()) {
+            return element(*any(arrays), d);
+        }
+    }
+    if (r < 70) {
+        return "(" + exp(d + 1) + ")";
+    }
+    if (r < 85) {
+        auto res = call(d, true);
+        if (!res.empty()) {
+            return res;
+        }
+    }
+    auto left = number(9);
+    auto op = "+-*"[below(3)];
+    return "(" + left + " " + op + " " + number(9) + ")";
+}
+
+// UnaryExp, "!" only goes into a Cond
+std::string Builder::unary(int d) {
+    if (d < config.expressionDepth && chance(15)) {
+        auto operand = unary(d + 1);
+        if (operand[0] == '-' || operand[0] == '+') {
+            operand = "(" + operand + ")";
+        }
+        return (chance(70) ? "-" : "+") + operand;
+    }
+    return atom(d);
+}
+
+// divisors are in [2, 14]
+std::string Builder::mul(int d) {
+    auto res = unary(d);
+    for (int n = d < config.expressionDepth ? below(3) : 0; n > 0; --n) {
+        auto op = below(3);
+        if (op == 0) {
+            res += " * " + unary(d + 1);
+        } else {
+            res += std::string(op == 1 ? " / " : " % ") + "(" + unary(d + 1) + " % 7 + 8)";
+        }
+    }
+    return res;
+}
+
+std::string Builder::exp(int d) {
+    auto res = mul(d);
+    for (int n = d < config.expressionDepth ? below(3) : 0; n > 0; --n) {
+        res += chance(50) ? " + " : " - ";
+        res += mul(d + 1);
+    }
+    return res;
+}
+
+// EqExp of RelExp
+std::string Builder::eq() {
+    static const char *rel[] = {" < ", " > ", " <= ", " >= "};
+    static const char *equal[] = {" == ", " != "};
+    auto r = below(100);
+    if (r < 15) {
+        return chance(50) ? "!(" + exp(1) + ")" : "!" + atom(config.expressionDepth);
+    }
+    if (r < 25) {
+        return exp(1);
+    }
+    // one at a time, the operands of + are evaluated in any order
+    auto res = exp(r < 90 ? 1 : 2);
+    if (r < 60 || r >= 90) {
+        res += rel[below(4)];
+        res += exp(r < 90 ? 1 : 2);
+    }
+    if (r >= 60) {
+        res += equal[below(2)];
+        res += exp(r < 90 ? 1 : 2);
+    }
+    return res;
+}
+
+// LOrExp of LAndExp
+std::string Builder::cond() {
+    std::string res;
+    for (int i = 1 + (chance(30) ? below(2) + 1 : 0); i > 0; --i) {
+        res += res.empty() ? "" : " || ";
+        auto term = eq();
+        for (int j = chance(30) ? below(2) + 1 : 0; j > 0; --j) {
+            term += " && " + eq();
+        }
+        res += term;
+    }
+    return res;
+}
+
+// argument for a parameter of dims, "" if nothing in scope fits
+std::string Builder::arg(const std::vector<int> &param, int d) {
+    if (param.empty()) {
+        return exp(d + 1);
+    }
+    std::vector<std::string> fits;
+    for (auto &v: scope) {
+        if (v.constant || v.dims.empty()) {
+            continue;
+        }
+        if (param.size() == 1 && v.dims.size() == 1 && v.dims[0] >= param[0]) {
+            fits.push_back(v.name);
+        } else if (param.size() == 1 && v.dims.size() == 2 && v.dims[1] >= param[0]) {
+            fits.push_back(v.name + "[" + number(v.dims[0]) + "]");
+        } else if (param.size() == 2 && v.dims.size() == 2 && v.dims[0] >= param[0] && v.dims[1] == param[1]) {
+            fits.push_back(v.name);
+        }
+    }
+    return fits.empty() ? "" : any(fits);
+}
+
+// a call of a function defined before, "" if none fits in the budget
+// one inside an expression returns int and is pure, as C leaves the order of the operands open
+std::string Builder::call(int d, bool inExp) {
+    std::vector<std::size_t> candidates;
+    for (std::size_t i = 0; i < funcs.size(); ++i) {
+        if ((!inExp || (funcs[i].returnsInt && funcs[i].pure)) && work + trips * funcs[i].work <= budget) {
+            candidates.push_back(i);
+        }
+    }
+    if (candidates.empty()) {
+        return "";
+    }
+    auto &func = funcs[any(candidates)];
+    std::string args;
+    for (auto &param: func.params) {
+        auto a = arg(param, d);
+        if (a.empty()) {
+            return "";
+        }
+        args += (args.empty() ? "" : ", ") + a;
+    }
+    work += trips * func.work;
+    func.called = true;
+    pure &= func.pure;
+    return func.name + "(" + args + ")";
+}
+
+// a ConstDecl or VarDecl of one to three Defs
+void Builder::decl(int indent, bool global) {
+    bool constant = chance(25);
+    std::string text = constant ? "const int " : "int ";
+    for (int n = chance(20) ? 2 + below(2) : 1; n > 0; --n) {
+        Var v{global ? fresh("g") : fresh(constant ? "c" : "v"), {}};
+        v.constant = constant;
+        v.local = !global;
+        if (config.arrayDims > 0 && chance(35)) {
+            for (int i = 1 + below(config.arrayDims); i > 0; --i) {
+                v.dims.push_back(1 + below(5));
+            }
+        }
+        auto def = v.name + dims(v.dims);
+        // globals and constants take constant initial values, locals always one, C leaves them undefined
+        bool numbers = global || constant;
+        if (!global || constant || chance(60)) {
+            def += " = " + (v.dims.empty() ? (numbers ? number(30) : exp(1)) : init(v.dims, numbers, 2));
+        }
+        text += (text.back() == ' ' ? "" : ", ") + def;
+        (global ? globals : scope).push_back(std::move(v));
+    }
+    line(indent, text + ";");
+}
+
+void Builder::block(int indent) {
+    auto size = scope.size();
+    ++depth;
+    for (int n = 1 + below(config.statements); n > 0; --n) {
+        statement(indent);
+    }
+    --depth;
+    scope.erase(scope.begin() + static_cast<std::ptrdiff_t>(size), scope.end());
+}
+
+void Builder::forStmt(int indent) {
+    Var counter{fresh("i"), {}};
+    counter.assignable = false;
+    counter.local = true;
+    auto &i = counter.name;
+    auto k = std::to_string(1 + below(TRIPS));
+    line(indent, "int " + i + ";");
+
+    // each ForStmt of BigForStmt may be missing, the increment never is so continue is safe
+    auto form = below(3);
+    if (form == 0) {
+        line(indent, "for (" + i + " = 0; " + i + " < " + k + "; " + i + " = " + i + " + 1) {");
+    } else if (form == 1) {
+        line(indent, i + " = 0;");
+        line(indent, "for (; " + i + " < " + k + "; " + i + " = " + i + " + 1) {");
+    } else {
+        line(indent, "for (" + i + " = 0; ; " + i + " = " + i + " + 1) {");
+        line(indent + 1, "if (" + i + " >= " + k + ") {");
+        line(indent + 2, "break;");
+        line(indent + 1, "}");
+    }
+
+    scope.push_back(std::move(counter));
+    auto outer = trips;
+    trips *= std::stoi(k);
+    ++loops;
+    block(indent + 1);
+    --loops;
+    trips = outer;
+    scope.pop_back();
+    line(indent, "}");
+}
+
+void Builder::statement(int indent) {
+    work += trips;
+    auto assignables = pick([](const Var &v) { return !v.constant && v.assignable; });
+    bool nest = depth < config.nestingDepth;
+    auto r = below(100);
+
+    if (r < 12) {
+        decl(indent, false);
+    } else if (r < 35 && !assignables.empty()) {
+        auto &var = *any(assignables);
+        pure &= var.local;
+        auto target = element(var, 1);
+        line(indent, target + " = " + exp() + ";");
+    } else if (r < 45 && nest) {
+        line(indent, "if (" + cond() + ") {");
+        block(indent + 1);
+        if (chance(50)) {
+            line(indent, "} else {");
+            block(indent + 1);
+        }
+        line(indent, "}");
+    } else if (r < 55 && nest && loops < config.loopDepth) {
+        forStmt(indent);
+    } else if (r < 60 && loops > 0) {
+        line(indent, "if (" + cond() + ") {");
+        line(indent + 1, chance(50) ? "break;" : "continue;");
+        line(indent, "}");
+    } else if (r < 68) {
+        auto n = below(3);
+        std::string format = fresh("p");
+        std::string args;
+        for (int i = 0; i < n; ++i) {
+            format += " %d";
+            args += ", " + exp();
+        }
+        line(indent, "printf(\"" + format + "\\n\"" + args + ");");
+        pure = false;
+    } else if (r < 72 && !assignables.empty()) {
+        line(indent, element(*any(assignables), 1) + " = getint();");
+        pure = false;
+    } else if (r < 76 && depth > 1) {
+        line(indent, "if (" + cond() + ") {");
+        line(indent + 1, returnsInt ? "return " + exp() + ";" : "return;");
+        line(indent, "}");
+    } else if (r < 86) {
+        auto res = call(0, false);
+        if (res.empty()) {
+            res = chance(20) ? "" : exp();
+        }
+        line(indent, res + ";");
+    } else if (nest) {
+        line(indent, "{");
+        block(indent + 1);
+        line(indent, "}");
+    } else {
+        line(indent, ";");
+    }
+}
+
+void Builder::function() {
+    Func func{fresh("f"), chance(70), {}};
+    std::string params;
+    scope = globals;
+    for (int n = below(4); n > 0; --n) {
+        Var v{fresh("a"), {}};
+        auto r = below(100);
+        if (config.arrayDims > 0 && r < 25) {
+            v.dims = {1 + below(4)};
+        } else if (config.arrayDims > 1 && r < 40) {
+            v.dims = {1 + below(4), 1 + below(3)};
+        }
+        // an array parameter is the array of the caller
+        v.local = v.dims.empty();
+        params += (params.empty() ? "int " : ", int ") + v.name;
+        if (!v.dims.empty()) {
+            params += v.dims.size() == 1 ? "[]" : "[][" + std::to_string(v.dims[1]) + "]";
+        }
+        func.params.push_back(v.dims);
+        scope.push_back(std::move(v));
+    }
+
+    returnsInt = func.returnsInt;
+    pure = true;
+    work = 0;
+    budget = FUNCTION_BUDGET;
+    line(0, std::string(returnsInt ? "int " : "void ") + func.name + "(" + params + ") {");
+    block(1);
+    if (returnsInt) {
+        line(1, "return " + exp() + ";");
+    } else if (chance(50)) {
+        line(1, "return;");
+    }
+    line(0, "}");
+    line(0, "");
+
+    func.work = work + 1;
+    func.pure = pure;
+    funcs.push_back(std::move(func));
+}
+
+void Builder::mainFunction() {
+    scope = globals;
+    returnsInt = true;
+    work = 0;
+    budget = MAIN_BUDGET;
+    line(0, "int main() {");
+    block(1);
+
+    // so every function is compiled, removeUncalledFunctions would drop the rest
+    for (auto &func: funcs) {
+        if (func.called) {
+            continue;
+        }
+        std::string args;
+        for (auto &param: func.params) {
+            args += (args.empty() ? "" : ", ") + arg(param, 0);
+        }
+        line(1, func.name + "(" + args + ");");
+    }
+
+    for (auto &v: globals) {
+        auto first = v.name;
+        for (std::size_t i = 0; i < v.dims.size(); ++i) {
+            first += "[0]";
+        }
+        line(1, "printf(\"" + v.name + " %d\\n\", " + first + ");");
+    }
+    line(1, "return 0;");
+    line(0, "}");
+}
+
+std::string Builder::build() {
+    for (int i = 0; i < config.globals; ++i) {
+        decl(0, true);
+    }
+    // an array parameter asks for at least 4 elements, or 4 rows of 1 to 3
+    if (config.arrayDims > 0) {
+        globals.push_back({fresh("g"), {4}});
+        line(0, "int " + globals.back().name + "[4];");
+    }
+    if (config.arrayDims > 1) {
+        for (int columns = 1; columns <= 3; ++columns) {
+            globals.push_back({fresh("g"), {4, columns}});
+            line(0, "int " + globals.back().name + dims(globals.back().dims) + ";");
+        }
+    }
+    line(0, "");
+
+    for (int i = 0; i < config.functions; ++i) {
+        function();
+    }
+    // main takes a line per function never called
+    while (lines + funcs.size() + 2 * globals.size() < config.lines) {
+        function();
+    }
+    mainFunction();
+    return std::move(out);
+}
+} // namespace
+
+std::string Generator::generate(const Config &config) {
+    Config valid = config;
+    valid.arrayDims = std::clamp(valid.arrayDims, 0, 2);
+    valid.nestingDepth = std::max(valid.nestingDepth, 1);
+    valid.loopDepth = std::clamp(valid.loopDepth, 0, valid.nestingDepth);
+    valid.expressionDepth = std::max(valid.expressionDepth, 1);
+    valid.statements = std::max(valid.statements, 1);
+    return Builder(valid).build();
+}
+
+bool Generator::set(Config &config, const std::string &option, const std::string &value) {
+    struct Field {
+        const char *option;
+        int Config::*field;
+    };
+    static const Field fields[] = {
+            {"--functions", &Config::functions},
+            {"--globals", &Config::globals},
+            {"--array-dims", &Config::arrayDims},
+            {"--nesting-depth", &Config::nestingDepth},
+            {"--loop-depth", &Config::loopDepth},
+            {"--expression-depth", &Config::expressionDepth},
+            {"--statements", &Config::statements},
+    };
+
+    auto field = std::find_if(std::begin(fields), std::end(fields), [&](const Field &f) { return option == f.option; });
+    if (field == std::end(fields) && option != "--seed" && option != "--lines") {
+        return false;
+    }
+
+    long long n = -1;
+    try {
+        std::size_t end = 0;
+        n = std::stoll(value, &end);
+        n = end == value.size() ? n : -1;
+    } catch (const std::exception &) {}
+    if (n < 0 || (field != std::end(fields) && n > 1'000'000'000)) {
+        throw std::invalid_argument("bad value " + value + " of " + option);
+    }
+
+    if (option == "--seed") {
+        config.seed = static_cast<std::uint32_t>(n);
+    } else if (option == "--lines") {
+        config.lines = static_cast<std::size_t>(n);
+    } else {
+        config.*field->field = static_cast<int>(n);
+    }
+    return true;
+}
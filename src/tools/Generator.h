@@ -0,0 +1,41 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_GENERATOR_H
+#define COMPILER_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Seeded generator of valid SysY programs, for scaling and stress tests.
+// The same Config gives the same program on every platform.
+// Programs use every AST node type, never divide by zero or index out of bounds,
+// never recurse, and run a bounded number of statements: loops have constant trip counts,
+// and a call is only made while the estimated statements of the caller stay under a budget.
+// Calls inside expressions have no side effect, so the output is the same in any order of evaluation,
+// and gcc with getint() reading 0 past the input gives the reference output.
+namespace Generator {
+struct Config {
+    std::uint32_t seed{1};
+    int functions{8};       // besides main
+    int globals{6};         // besides the arrays every array parameter can be given
+    int arrayDims{2};       // most dimensions of an array, 0 for no arrays
+    int nestingDepth{3};    // of blocks, if and for inside a function body
+    int loopDepth{2};       // of for inside each other, at most nestingDepth
+    int expressionDepth{3}; // of operators and parentheses inside an expression
+    int statements{6};      // most statements in a block
+    // if not 0, functions are added until the program has about that many lines
+    std::size_t lines{};
+};
+
+std::string generate(const Config &config);
+
+// set the field of config named by option ("--seed", "--functions", "--globals", "--array-dims",
+// "--nesting-depth", "--loop-depth", "--expression-depth", "--statements", "--lines") to value
+// return false if option names no field, throw std::invalid_argument on a bad value
+bool set(Config &config, const std::string &option, const std::string &value);
+} // namespace Generator
+
+#endif
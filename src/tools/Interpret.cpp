@@ -0,0 +1,86 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Interpret.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "AST/CompUnit.h"
+#include "Context.h"
+#include "errorHandler/Error.h"
+#include "tools/MappedFile.h"
+
+Interpret::Stage Interpret::stage(const std::string &file, const Opt::Config &optimize, const std::string &input,
+                                  const Interp::Config &config) {
+    Context context;
+    Context::Scope scope(context);
+    context.exp.foldOffsets = optimize.foldOffsets;
+    Lexer::init(file, "");
+    auto compUnit = CompUnit::parse();
+    if (Error::hasError()) {
+        throw std::runtime_error(file + ": compile error");
+    }
+    auto module = compUnit->genIR();
+    optimize.pipeline.run(*module);
+
+    std::istringstream in(input);
+    std::ostringstream out;
+    auto result = Interp::run(*module, in, out, config);
+    return {result, out.str()};
+}
+
+int Interpret::run(const Config &config) {
+    std::string input;
+    if (config.inputFile.empty()) {
+        input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    } else {
+        input = std::string(MappedFile(config.inputFile).view());
+    }
+    Interp::Config interpConfig{config.maxSteps};
+
+    auto stages = Opt::names(Opt::level(Opt::DEFAULT_LEVEL));
+    auto mips = Opt::passNames(Opt::Phase::MIPS);
+    stages.erase(std::remove_if(stages.begin(), stages.end(),
+                                [&](const std::string &name) { return std::count(mips.begin(), mips.end(), name); }),
+                 stages.end());
+
+    auto optimize = Opt::level(0);
+    std::vector<std::string> names{"unoptimized"};
+    std::vector<Interp::Result> results;
+    std::vector<std::string> outputs;
+    for (std::size_t n = 0; n <= stages.size(); ++n) {
+        if (n > 0) {
+            Opt::enable(optimize, stages[n - 1], true);
+            names.push_back("+" + stages[n - 1]);
+        }
+        auto [result, output] = stage(config.file, optimize, input, interpConfig);
+        results.push_back(result);
+        outputs.push_back(std::move(output));
+    }
+
+    std::cout << outputs.back();
+    std::cout.flush();
+    Interp::compare(std::cerr, names, results);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (results[i].status == Interp::Result::Status::Fault) {
+            std::cerr << names[i] + ": " + results[i].fault + "\n";
+        }
+    }
+
+    int res = results.back().status == Interp::Result::Status::Exited ? EXIT_SUCCESS : EXIT_FAILURE;
+    for (std::size_t i = 1; i < results.size(); ++i) {
+        if (outputs[i] != outputs[0] || results[i].status != results[0].status
+            || results[i].exitCode != results[0].exitCode) {
+            std::cerr << names[i] + " changes the behavior of the program\n";
+            res = EXIT_FAILURE;
+        }
+    }
+    return res;
+}
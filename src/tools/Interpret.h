@@ -0,0 +1,39 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_INTERPRET_H
+#define COMPILER_INTERPRET_H
+
+#include <cstdint>
+#include <string>
+
+#include "middle/PassManager.h"
+#include "sim/Interpreter.h"
+
+// "--interp": run the IR of a source on Interp before and after each optimization,
+// to find the pass changing what the program does.
+namespace Interpret {
+struct Config {
+    std::string file;
+    std::string inputFile; // stdin if empty
+    std::int64_t maxSteps{};
+};
+
+struct Stage {
+    Interp::Result result;
+    std::string output;
+};
+
+// compile file to IR with the optimizations of optimize before MIPS and interpret it
+// throw std::runtime_error on a compile error
+Stage stage(const std::string &file, const Opt::Config &optimize, const std::string &input,
+            const Interp::Config &config);
+
+// run the IR of a source with no optimization, then adding one by one those of -O2 before MIPS,
+// the counts of every stage go to stderr, the output of the last one to stdout
+// a stage printing or exiting differently from the IR before the passes fails
+int run(const Config &config);
+} // namespace Interpret
+
+#endif
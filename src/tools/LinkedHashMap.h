@@ -64,6 +64,14 @@ public:
         return data.end();
     }
 
+    typename std::list<std::pair<K, V>>::const_iterator begin() const {
+        return data.begin();
+    }
+
+    typename std::list<std::pair<K, V>>::const_iterator end() const {
+        return data.end();
+    }
+
 private:
     std::list<std::pair<K, V>> data;
     std::unordered_map<K, typename std::list<std::pair<K, V>>::iterator> key_to_iterator;
@@ -0,0 +1,143 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path) {
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("Reading " + path + " fails!");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        release();
+        throw std::runtime_error("Reading " + path + " fails!");
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+
+    // an empty file can't be mapped, an empty view is enough
+    if (size == 0) {
+        return;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        release();
+        throw std::runtime_error("Mapping " + path + " fails!");
+    }
+
+    data = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        release();
+        throw std::runtime_error("Mapping " + path + " fails!");
+    }
+}
+
+void MappedFile::release() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+#else
+MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Reading " + path + " fails!");
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error("Reading " + path + " fails!");
+    }
+    size = static_cast<std::size_t>(st.st_size);
+
+    // mmap rejects length 0, an empty view is enough
+    if (size != 0) {
+        void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            size = 0;
+            throw std::runtime_error("Mapping " + path + " fails!");
+        }
+        // the lexer scans forward only
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(p);
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+void MappedFile::release() {
+    if (data) {
+        munmap(const_cast<char *>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+}
+#endif
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+    data(std::exchange(other.data, nullptr)),
+    size(std::exchange(other.size, 0))
+#ifdef _WIN32
+    ,
+    fileHandle(std::exchange(other.fileHandle, nullptr)),
+    mappingHandle(std::exchange(other.mappingHandle, nullptr))
+#endif
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        release();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+std::string_view MappedFile::view() const {
+    if (data == nullptr) {
+        return {};
+    }
+    return {data, size};
+}
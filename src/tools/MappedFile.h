@@ -0,0 +1,43 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_MAPPEDFILE_H
+#define COMPILER_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// read-only memory mapping of a whole file
+// views returned by view() are valid until the MappedFile is destroyed or reassigned
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    // throw std::runtime_error if the file can't be opened or mapped
+    explicit MappedFile(const std::string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    std::string_view view() const;
+
+private:
+    const char *data{nullptr};
+    std::size_t size{0};
+
+#ifdef _WIN32
+    void *fileHandle{nullptr};
+    void *mappingHandle{nullptr};
+#endif
+
+    void release();
+};
+
+#endif
@@ -0,0 +1,85 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Simulate.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "middle/Profile.h"
+#include "tools/Driver.h"
+#include "tools/MappedFile.h"
+#include "tools/ThreadPool.h"
+
+namespace {
+// run program on stdin or inputFile, its output goes to stdout
+Sim::Result run(const Sim::Program &program, const Simulate::Config &config) {
+    std::ifstream inputStream;
+    if (!config.inputFile.empty()) {
+        inputStream.open(config.inputFile);
+        if (!inputStream) {
+            throw std::runtime_error("Reading " + config.inputFile + " fails!");
+        }
+    }
+    auto result = Sim::run(program, config.inputFile.empty() ? std::cin : inputStream, std::cout, config.sim);
+    std::cout.flush();
+    return result;
+}
+} // namespace
+
+int Simulate::simulate(const Config &config) {
+    auto program = Sim::Program::parse(MappedFile(config.file).view());
+    auto result = run(program, config);
+    Sim::report(std::cerr, result, config.sim.weights);
+    return result.status == Sim::Result::Status::Exited ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int Simulate::profile(Config config) {
+    auto dir = Driver::dirOf(config.file);
+    Profile::Blocks blocks;
+    {
+        ThreadPool pool;
+        Driver::Options compileOptions;
+        compileOptions.blocks = &blocks;
+        Profile::Frequencies frequencies;
+        if (!config.useProfile.empty()) {
+            frequencies = Profile::Frequencies::read(config.useProfile);
+            compileOptions.profile = &frequencies;
+        }
+        Driver::compile(config.file, "", dir + "error.txt", dir + "ir.txt", dir + "mips.txt", pool, compileOptions);
+    }
+
+    MappedFile assembly(dir + "mips.txt");
+    if (assembly.view().empty()) {
+        std::cerr << config.file + ": compile error, see " + dir + "error.txt\n";
+        return EXIT_FAILURE;
+    }
+    auto program = Sim::Program::parse(assembly.view());
+    config.sim.profile = true;
+    auto result = run(program, config);
+    Sim::report(std::cerr, result, config.sim.weights);
+
+    Sim::Rows rows;
+    Profile::Frequencies frequencies;
+    for (auto &[label, block]: blocks) {
+        rows[label] = block.row;
+        auto pc = program.labels.find(label);
+        auto entries = pc != program.labels.end() && pc->second < result.pcCounts.size() ? result.pcCounts[pc->second] : 0;
+        frequencies.add(block.function, label, entries);
+    }
+
+    std::ofstream out(dir + "profile.txt");
+    Sim::annotate(out, assembly.view(), program, result, config.sim.weights, rows);
+    if (!out) {
+        throw std::runtime_error("Writing " + dir + "profile.txt fails!");
+    }
+    std::ofstream freq(dir + "freq.txt");
+    frequencies.write(freq);
+    if (!freq) {
+        throw std::runtime_error("Writing " + dir + "freq.txt fails!");
+    }
+    return result.status == Sim::Result::Status::Exited ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,31 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_SIMULATE_H
+#define COMPILER_SIMULATE_H
+
+#include <string>
+
+#include "sim/Simulator.h"
+
+// "--sim" and "--profile": run the MIPS of a program on Sim with the input of the user,
+// its output goes to stdout and the cost to stderr.
+namespace Simulate {
+struct Config {
+    std::string file;
+    std::string inputFile; // stdin if empty
+    std::string useProfile; // only for profile()
+    Sim::Config sim;
+};
+
+// run a generated mips.txt
+int simulate(const Config &config);
+
+// compile a source into its directory and run it, then write there
+// profile.txt: mips.txt annotated with the counts, and the hottest IR BasicBlocks with their rows
+// freq.txt: the entries of each BasicBlock, for "--use-profile"
+int profile(Config config);
+} // namespace Simulate
+
+#endif
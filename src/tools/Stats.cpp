@@ -0,0 +1,381 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Stats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "Context.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace Stats;
+
+#ifdef COUNT_ALLOCATIONS
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<std::int64_t> allocationCount{0};
+std::atomic<std::int64_t> allocationBytes{0};
+} // namespace
+
+// the aligned and nothrow forms of the standard library call these
+void *operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (auto p = std::malloc(size)) {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void *operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+// every other form frees through this one, as operator new is the only allocator
+// GCC takes p for memory of the standard operator new, not of the malloc above
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void *p) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+void Stats::countAllocations(bool on) {
+    counting.store(on, std::memory_order_relaxed);
+}
+
+Allocations Stats::allocations() {
+    return {allocationCount.load(std::memory_order_relaxed), allocationBytes.load(std::memory_order_relaxed)};
+}
+#else
+void Stats::countAllocations(bool) {}
+
+Allocations Stats::allocations() {
+    return {};
+}
+#endif
+
+State &Stats::state() {
+    return Context::cur().stats;
+}
+
+bool Stats::enabled() {
+    auto &s = state();
+    return s.format != Format::None || s.trace;
+}
+
+std::string_view Stats::toString(Counter counter) {
+    switch (counter) {
+        case Counter::Tokens:
+            return "tokens";
+        case Counter::AstNodes:
+            return "AST nodes";
+        case Counter::Functions:
+            return "functions";
+        case Counter::IRInstructions:
+            return "IR instructions";
+        case Counter::Assemblies:
+            return "assemblies";
+        case Counter::AfterMergeMove_R_rt:
+            return "assemblies after mergeMove_R_rt";
+        case Counter::AfterMergeLi_R:
+            return "assemblies after mergeLi_R";
+        case Counter::COUNT:
+            break;
+    }
+    return "?";
+}
+
+void Stats::addFunction(FunctionStats function) {
+    auto &s = state();
+    std::lock_guard lock(s.mutex);
+    s.functions.push_back(std::move(function));
+}
+
+namespace {
+// caller holds s.mutex
+State::Timing &timing(State &s, std::string_view name) {
+    auto it = std::find_if(s.timings.begin(), s.timings.end(),
+                           [&](const State::Timing &t) { return t.name == name; });
+    if (it == s.timings.end()) {
+        it = s.timings.insert(it, {std::string(name)});
+    }
+    return *it;
+}
+} // namespace
+
+Timer::Timer(std::string_view name, std::string_view detail) :
+    name(name),
+    detail(detail),
+    running(enabled()) {
+    if (!running) {
+        return;
+    }
+    auto &s = state();
+    if (s.format != Format::None) {
+        // list outer scopes before the inner ones that end first
+        std::lock_guard lock(s.mutex);
+        timing(s, name);
+    }
+    beginAllocations = allocations();
+    begin = Trace::Clock::now();
+}
+
+Timer::~Timer() {
+    if (!running) {
+        return;
+    }
+    auto end = Trace::Clock::now();
+    auto endAllocations = allocations();
+
+    Allocations made{endAllocations.count - beginAllocations.count, endAllocations.bytes - beginAllocations.bytes};
+
+    auto &s = state();
+    if (s.trace) {
+        s.trace->add(name, detail, begin, end, made);
+    }
+    if (s.format != Format::None) {
+        auto memory = peakMemoryKiB();
+        std::lock_guard lock(s.mutex);
+        auto &t = timing(s, name);
+        ++t.calls;
+        t.time += end - begin;
+        t.peakMemoryKiB = std::max(t.peakMemoryKiB, memory);
+        t.allocations.count += made.count;
+        t.allocations.bytes += made.bytes;
+    }
+}
+
+Trace::Trace() :
+    start(Clock::now()) {}
+
+void Trace::add(std::string_view name, std::string_view detail, Clock::time_point begin, Clock::time_point end,
+                Allocations allocations) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    auto from = duration_cast<microseconds>(begin - start).count();
+    auto to = duration_cast<microseconds>(end - start).count();
+
+    std::lock_guard lock(mutex);
+    auto tid = tids.emplace(std::this_thread::get_id(), static_cast<int>(tids.size())).first->second;
+    events.push_back({std::string(name), std::string(detail), tid, from, to - from, allocations});
+}
+
+long Stats::peakMemoryKiB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss; // KiB on Linux
+#endif
+}
+
+namespace {
+double toMs(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+// names are identifiers and file paths, only quotes and backslashes need escaping
+std::string quote(std::string_view str) {
+    std::string res = "\"";
+    for (char c: str) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res + '"';
+}
+
+std::string format(const char *fmt, double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), fmt, value);
+    return buf;
+}
+
+// "a.b.c" -> "    c"
+std::string indented(std::string_view name) {
+    auto dot = name.find_last_of('.');
+    if (dot == std::string_view::npos) {
+        return std::string(name);
+    }
+    auto depth = std::count(name.begin(), name.end(), '.');
+    return std::string(2 * depth, ' ') + std::string(name.substr(dot + 1));
+}
+
+std::string padRight(std::string str, std::size_t width) {
+    if (str.size() < width) {
+        str.append(width - str.size(), ' ');
+    }
+    return str;
+}
+
+std::string padLeft(const std::string &str, std::size_t width) {
+    return str.size() < width ? std::string(width - str.size(), ' ') + str : str;
+}
+
+void table(std::ostream &out, std::string_view title, const State &s) {
+    std::string res = "==== compile report: " + std::string(title) + " ====\n";
+    res += padRight("phase", 40) + padLeft("calls", 10) + padLeft("time(ms)", 12) + padLeft("peak RSS(KiB)", 16);
+    if (ALLOCATIONS_COUNTED) {
+        res += padLeft("allocs", 12) + padLeft("alloc KiB", 12);
+    }
+    res += '\n';
+    for (auto &t: s.timings) {
+        res += padRight(indented(t.name), 40)
+               + padLeft(std::to_string(t.calls), 10)
+               + padLeft(format("%.3f", toMs(t.time)), 12)
+               + padLeft(std::to_string(t.peakMemoryKiB), 16);
+        if (ALLOCATIONS_COUNTED) {
+            res += padLeft(std::to_string(t.allocations.count), 12)
+                   + padLeft(std::to_string(t.allocations.bytes / 1024), 12);
+        }
+        res += '\n';
+    }
+    res += padRight("counter", 40) + padLeft("value", 10) + '\n';
+    for (std::size_t i = 0; i < s.counters.size(); ++i) {
+        res += padRight(std::string(toString(static_cast<Counter>(i))), 40)
+               + padLeft(std::to_string(s.counters[i].load()), 10) + '\n';
+    }
+    res += padRight("peak RSS(KiB)", 40) + padLeft(std::to_string(peakMemoryKiB()), 10) + '\n';
+    out << res;
+}
+
+void json(std::ostream &out, std::string_view title, const State &s) {
+    std::string res = "{\"file\": " + quote(title) + ", \"timers\": [";
+    for (std::size_t i = 0; i < s.timings.size(); ++i) {
+        auto &t = s.timings[i];
+        res += std::string(i ? ", " : "")
+               + "{\"name\": " + quote(t.name)
+               + ", \"calls\": " + std::to_string(t.calls)
+               + ", \"ms\": " + format("%.6f", toMs(t.time))
+               + ", \"peakRSSKiB\": " + std::to_string(t.peakMemoryKiB);
+        if (ALLOCATIONS_COUNTED) {
+            res += ", \"allocations\": " + std::to_string(t.allocations.count)
+                   + ", \"allocBytes\": " + std::to_string(t.allocations.bytes);
+        }
+        res += "}";
+    }
+    res += "], \"counters\": {";
+    for (std::size_t i = 0; i < s.counters.size(); ++i) {
+        res += std::string(i ? ", " : "")
+               + quote(toString(static_cast<Counter>(i))) + ": " + std::to_string(s.counters[i].load());
+    }
+    res += "}, \"functions\": [";
+
+    // functions are lowered in parallel, sort them for a stable report
+    auto functions = s.functions;
+    std::sort(functions.begin(), functions.end(),
+              [](const FunctionStats &a, const FunctionStats &b) { return a.name < b.name; });
+    for (std::size_t i = 0; i < functions.size(); ++i) {
+        auto &f = functions[i];
+        res += std::string(i ? ", " : "")
+               + "{\"name\": " + quote(f.name)
+               + ", \"IR instructions\": " + std::to_string(f.irInstructions)
+               + ", \"assemblies\": " + std::to_string(f.assemblies)
+               + ", \"after peephole\": " + std::to_string(f.afterPeephole) + "}";
+    }
+    res += "], \"peakRSSKiB\": " + std::to_string(peakMemoryKiB()) + "}\n";
+    out << res;
+}
+} // namespace
+
+void Stats::report(std::ostream &out, std::string_view title) {
+    auto &s = state();
+    std::lock_guard lock(s.mutex);
+    switch (s.format) {
+        case Format::None:
+            break;
+        case Format::Table:
+            table(out, title, s);
+            break;
+        case Format::Json:
+            json(out, title, s);
+            break;
+    }
+}
+
+void Trace::write(std::ostream &out) const {
+    std::lock_guard lock(mutex);
+
+    // complete events ("ph": "X"), the viewer nests the spans of a thread by time
+    std::vector<const Event *> sorted;
+    for (auto &e: events) {
+        sorted.push_back(&e);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Event *a, const Event *b) {
+        return a->begin < b->begin || (a->begin == b->begin && a->duration > b->duration);
+    });
+
+    std::string res = "{\"traceEvents\": [\n";
+    for (std::size_t tid = 0; tid < tids.size(); ++tid) {
+        res += "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " + std::to_string(tid)
+               + ", \"args\": {\"name\": \"thread " + std::to_string(tid) + "\"}},\n";
+    }
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        auto e = sorted[i];
+        res += "{\"name\": " + quote(e->name)
+               + ", \"cat\": \"compile\", \"ph\": \"X\", \"pid\": 1, \"tid\": " + std::to_string(e->tid)
+               + ", \"ts\": " + std::to_string(e->begin)
+               + ", \"dur\": " + std::to_string(e->duration);
+        std::string args;
+        if (!e->detail.empty()) {
+            args += "\"detail\": " + quote(e->detail);
+        }
+        if (ALLOCATIONS_COUNTED) {
+            args += std::string(args.empty() ? "" : ", ")
+                    + "\"allocations\": " + std::to_string(e->allocations.count)
+                    + ", \"allocBytes\": " + std::to_string(e->allocations.bytes);
+        }
+        if (!args.empty()) {
+            res += ", \"args\": {" + args + "}";
+        }
+        res += i + 1 < sorted.size() ? "},\n" : "}\n";
+    }
+    out << res << "]}\n";
+}
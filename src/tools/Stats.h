@@ -0,0 +1,169 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_STATS_H
+#define COMPILER_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Compile time report: scoped timers, counters and peak memory of one compilation.
+// Everything is off unless State::format or State::trace is set, then a disabled Timer or count costs one branch.
+// Timers and counters may be used on any thread running for the compilation.
+namespace Stats {
+// operator new is only replaced in a build configured with -DCOUNT_ALLOCATIONS=ON,
+// other builds count nothing and report no allocations
+#ifdef COUNT_ALLOCATIONS
+constexpr bool ALLOCATIONS_COUNTED = true;
+#else
+constexpr bool ALLOCATIONS_COUNTED = false;
+#endif
+
+// operator new calls and bytes of the whole process, counted only while countAllocations is on
+struct Allocations {
+    std::int64_t count{};
+    std::int64_t bytes{};
+};
+
+// spans of every Timer of the compilations using it, written as Chrome trace event JSON
+// (chrome://tracing, ui.perfetto.dev), the compilations of a batch share one Trace
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Trace();
+
+    Trace(const Trace &) = delete;
+    Trace &operator=(const Trace &) = delete;
+
+    // detail: the file or function the span belongs to, may be empty
+    // allocations: made during the span, only written if ALLOCATIONS_COUNTED
+    void add(std::string_view name, std::string_view detail, Clock::time_point begin, Clock::time_point end,
+             Allocations allocations = {});
+
+    // {"traceEvents": [...]}, times in microseconds since the Trace was made
+    void write(std::ostream &out) const;
+
+private:
+    struct Event {
+        std::string name;
+        std::string detail;
+        int tid;
+        std::int64_t begin;
+        std::int64_t duration;
+        Allocations allocations;
+    };
+
+    Clock::time_point start;
+
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::map<std::thread::id, int> tids; // small ids in order of first span
+};
+
+enum class Format {
+    None,
+    Table,
+    Json,
+};
+
+enum class Counter {
+    Tokens,
+    AstNodes,
+    Functions,
+    IRInstructions,    // after optimization, as lowered to MIPS
+    Assemblies,        // lowered, before peephole
+    AfterMergeMove_R_rt,
+    AfterMergeLi_R,
+    COUNT,
+};
+
+std::string_view toString(Counter counter);
+
+// the same per function, for Format::Json
+struct FunctionStats {
+    std::string name;
+    std::int64_t irInstructions{};
+    std::int64_t assemblies{};
+    std::int64_t afterPeephole{};
+};
+
+// stats of one compilation, owned by Context
+struct State {
+    Format format{Format::None};
+    // spans of Timers also go here if not nullptr
+    Trace *trace{};
+
+    std::array<std::atomic<std::int64_t>, static_cast<std::size_t>(Counter::COUNT)> counters{};
+
+    struct Timing {
+        std::string name;
+        std::int64_t calls{};
+        std::chrono::nanoseconds time{};
+        long peakMemoryKiB{}; // peak of the process when the last call ended
+        Allocations allocations{}; // made by the whole process during the calls, see countAllocations
+    };
+
+    // guards timings and functions
+    std::mutex mutex;
+    std::vector<Timing> timings; // in order of first use
+    std::vector<FunctionStats> functions;
+};
+
+State &state();
+
+bool enabled();
+
+// counters only count for a report
+inline void count(Counter counter, std::int64_t n = 1) {
+    auto &s = state();
+    if (s.format != Format::None) {
+        s.counters[static_cast<std::size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+void addFunction(FunctionStats function);
+
+// time the enclosing scope under name, scopes of the same name add up
+// "a.b" is a part of "a", parts run on several threads may add up to more than "a"
+// detail only shows in the trace, see Trace::add
+// name and detail must outlive the Timer
+class Timer {
+public:
+    explicit Timer(std::string_view name, std::string_view detail = {});
+    ~Timer();
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
+private:
+    std::string_view name;
+    std::string_view detail;
+    bool running;
+    Trace::Clock::time_point begin;
+    Allocations beginAllocations;
+};
+
+// off by default, the replaced operator new then costs one branch, nothing without ALLOCATIONS_COUNTED
+void countAllocations(bool on);
+
+Allocations allocations();
+
+// peak resident memory of the whole process so far, 0 if unknown
+long peakMemoryKiB();
+
+// the report of the current compilation in its format, nothing for Format::None
+void report(std::ostream &out, std::string_view title);
+} // namespace Stats
+
+#endif
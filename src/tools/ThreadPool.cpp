@@ -0,0 +1,137 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned size) {
+    if (size == 0) {
+        size = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(size - 1);
+    for (unsigned i = 1; i < size; ++i) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    hasWork.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t n, const std::function<void(std::size_t)> &fn) {
+    if (n == 0) {
+        return;
+    }
+
+    auto loop = std::make_shared<Loop>();
+    loop->id = ++lastId;
+    loop->fn = &fn;
+    loop->n = n;
+
+    if (!workers.empty() && n > 1) {
+        {
+            std::lock_guard lock(mutex);
+            loops.push_back(loop);
+        }
+        hasWork.notify_all();
+        loopDone.notify_all();
+    }
+
+    while (runOne(*loop)) {
+    }
+    retire(loop);
+
+    while (true) {
+        std::shared_ptr<Loop> other;
+        {
+            std::unique_lock lock(mutex);
+            loopDone.wait(lock, [&] { return loop->done.load() == n || (other = pick(loop->id)); });
+            if (loop->done.load() == n) {
+                break;
+            }
+        }
+        if (!runOne(*other)) {
+            retire(other);
+        }
+    }
+
+    if (loop->error) {
+        std::rethrow_exception(loop->error);
+    }
+}
+
+void ThreadPool::work() {
+    while (true) {
+        std::shared_ptr<Loop> loop;
+        {
+            std::unique_lock lock(mutex);
+            hasWork.wait(lock, [&] { return stopping || (loop = pick(0)); });
+            if (stopping) {
+                return;
+            }
+        }
+
+        // one index at a time, the next may come from a loop started meanwhile
+        if (!runOne(*loop)) {
+            retire(loop);
+        }
+    }
+}
+
+std::shared_ptr<ThreadPool::Loop> ThreadPool::pick(std::uint64_t after) const {
+    std::shared_ptr<Loop> res;
+    std::size_t most = 0;
+    for (auto &loop: loops) {
+        auto next = loop->next.load();
+        auto left = next < loop->n ? loop->n - next : 0;
+        if (loop->id > after && left > most) {
+            res = loop;
+            most = left;
+        }
+    }
+    return res;
+}
+
+bool ThreadPool::runOne(Loop &loop) {
+    std::size_t i = loop.next.fetch_add(1);
+    if (i >= loop.n) {
+        return false;
+    }
+
+    try {
+        (*loop.fn)(i);
+    } catch (...) {
+        std::lock_guard lock(loop.errorMutex);
+        if (!loop.error) {
+            loop.error = std::current_exception();
+        }
+    }
+
+    if (loop.done.fetch_add(1) + 1 == loop.n) {
+        std::lock_guard lock(mutex);
+        loopDone.notify_all();
+    }
+    return true;
+}
+
+// all indices are handed out, stop offering the loop to idle workers
+void ThreadPool::retire(const std::shared_ptr<Loop> &loop) {
+    std::lock_guard lock(mutex);
+    auto it = std::find(loops.begin(), loops.end(), loop);
+    if (it != loops.end()) {
+        loops.erase(it);
+    }
+}
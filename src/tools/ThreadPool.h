@@ -0,0 +1,77 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_THREADPOOL_H
+#define COMPILER_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running index loops.
+// The calling thread of parallelFor takes part in its own loop,
+// so a task may call parallelFor again without deadlock,
+// and a pool of size 1 (no worker) runs everything in order on the caller.
+// An idle worker takes its next index from whichever pending loop has the most left,
+// so the loops nested in the tasks of another (the functions of each file in batch mode) are shared too.
+// A caller waiting for the last indices of its loop helps the loops started after it the same way,
+// never an older one, whose task could hold it much longer.
+class ThreadPool {
+public:
+    // size counts the calling thread, 0 means one per hardware thread
+    explicit ThreadPool(unsigned size = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const;
+
+    // run fn(0) ... fn(n - 1) in any order, return when all have finished
+    // indices are handed out one by one, so uneven tasks balance themselves
+    // the first exception thrown by fn is rethrown here after the others finish
+    void parallelFor(std::size_t n, const std::function<void(std::size_t)> &fn);
+
+private:
+    struct Loop {
+        std::uint64_t id; // loops started later have greater ids
+        const std::function<void(std::size_t)> *fn;
+        std::size_t n;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable hasWork;
+    std::condition_variable loopDone;
+    std::deque<std::shared_ptr<Loop>> loops;
+    std::atomic<std::uint64_t> lastId{0};
+    bool stopping = false;
+
+    void work();
+
+    // the loop in loops started after the one with id after, with the most indices left, nullptr if none
+    // called with mutex held
+    std::shared_ptr<Loop> pick(std::uint64_t after) const;
+
+    // claim and run one index of loop, return false if none is left
+    bool runOne(Loop &loop);
+
+    void retire(const std::shared_ptr<Loop> &loop);
+};
+
+#endif
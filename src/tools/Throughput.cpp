@@ -0,0 +1,226 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#include "Throughput.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "AST/CompUnit.h"
+#include "Context.h"
+#include "backend/MIPS.h"
+#include "errorHandler/Error.h"
+#include "middle/PassManager.h"
+#include "tools/Stats.h"
+
+using namespace Throughput;
+
+namespace {
+// what the throughput of a phase counts
+struct Units {
+    std::int64_t tokens{};
+    std::int64_t generated{}; // IR instructions out of genIR
+    std::int64_t lowered{};   // IR instructions into genMIPS, after the passes
+    std::int64_t assemblies{}; // before the peephole
+    std::int64_t emitted{};    // after the peephole
+};
+
+struct Phase {
+    const char *name; // of its Stats::Timer
+    const char *unit;
+    std::int64_t Units::*count;
+};
+
+constexpr Phase phases[] = {
+        {"lex", "tokens", &Units::tokens},
+        {"parse", "tokens", &Units::tokens},
+        {"genIR", "IR", &Units::generated},
+        {"optimize", "IR", &Units::generated},
+        {"genMIPS", "IR", &Units::lowered},
+        {"genMIPS.lower", "IR", &Units::lowered},
+        {"genMIPS.peephole", "asm", &Units::assemblies},
+        {"genMIPS.emit", "asm", &Units::emitted},
+};
+constexpr std::size_t PHASES = std::size(phases);
+
+struct Measure {
+    Units units;
+    std::array<std::chrono::nanoseconds, PHASES> time{};
+    std::array<Stats::Allocations, PHASES> allocations{};
+};
+
+std::int64_t countIR(const IR::Module &module) {
+    auto count = [](const IR::Function &func) {
+        std::int64_t res = 0;
+        for (auto &block: func.getBasicBlocks()) {
+            res += static_cast<std::int64_t>(block->instructions.size());
+        }
+        return res;
+    };
+    auto res = count(module.getMainFunction());
+    for (auto &func: module.getFunctions()) {
+        res += count(*func);
+    }
+    return res;
+}
+
+// time and allocations of the phases timed in stats
+void collect(const Stats::State &stats, Measure &res) {
+    for (std::size_t i = 0; i < PHASES; ++i) {
+        for (auto &t: stats.timings) {
+            if (t.name == phases[i].name) {
+                res.time[i] = t.time;
+                res.allocations[i] = t.allocations;
+            }
+        }
+    }
+}
+
+std::int64_t counter(const Stats::State &stats, Stats::Counter counter) {
+    return stats.counters[static_cast<std::size_t>(counter)];
+}
+
+// lex the file alone, then compile it like compile() without writing any output
+// each in a Context of its own, as Lexer::init only works on a fresh Lexer::State
+Measure measure(const std::string &file) {
+    Measure res;
+    {
+        Context context;
+        Context::Scope scope(context);
+        context.stats.format = Stats::Format::Table;
+        {
+            Stats::Timer timer("lex");
+            Lexer::init(file, "");
+            while (Lexer::next().first != LexType::LEX_END) {}
+        }
+        res.units.tokens = counter(context.stats, Stats::Counter::Tokens);
+        collect(context.stats, res);
+    }
+
+    Context context;
+    Context::Scope scope(context);
+    context.stats.format = Stats::Format::Table;
+    Lexer::init(file, "");
+    auto compUnit = CompUnit::parse();
+    if (Error::hasError()) {
+        throw std::runtime_error(file + ": compile error");
+    }
+    auto module = compUnit->genIR();
+    res.units.generated = countIR(*module);
+    Opt::level(Opt::DEFAULT_LEVEL).pipeline.run(*module);
+    MIPS::genMIPS(*module);
+
+    res.units.lowered = counter(context.stats, Stats::Counter::IRInstructions);
+    res.units.assemblies = counter(context.stats, Stats::Counter::Assemblies);
+    res.units.emitted = counter(context.stats, Stats::Counter::AfterMergeLi_R);
+    collect(context.stats, res);
+    return res;
+}
+
+std::string format(const char *fmt, double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), fmt, value);
+    return buf;
+}
+
+std::string padLeft(const std::string &str, std::size_t width) {
+    return str.size() < width ? std::string(width - str.size(), ' ') + str : str;
+}
+
+std::string padRight(std::string str, std::size_t width) {
+    str.resize(std::max(str.size() + 1, width), ' ');
+    return str;
+}
+
+double nsPer(std::chrono::nanoseconds time, std::int64_t units) {
+    return units > 0 ? static_cast<double>(time.count()) / static_cast<double>(units) : 0;
+}
+} // namespace
+
+void Throughput::run(std::ostream &out, const Config &config) {
+    std::filesystem::create_directories(config.dir);
+    Stats::countAllocations(true);
+
+    std::vector<std::size_t> sizes;
+    std::vector<Measure> measures;
+    for (auto lines: config.lines) {
+        auto shape = config.generator;
+        shape.lines = lines;
+        auto source = Generator::generate(shape);
+        auto file = config.dir + std::to_string(lines) + ".txt";
+        {
+            std::ofstream stream(file, std::ios::binary);
+            stream << source;
+            if (!stream) {
+                throw std::runtime_error("Writing " + file + " fails!");
+            }
+        }
+        auto realLines = static_cast<std::size_t>(std::count(source.begin(), source.end(), '\n'));
+        source = {};
+
+        // small sources run several times, the fastest run of each phase counts
+        std::size_t runs = std::max<std::size_t>(100'000 / std::max<std::size_t>(realLines, 1), 1);
+        auto best = measure(file);
+        for (std::size_t r = 1; r < runs; ++r) {
+            auto m = measure(file);
+            for (std::size_t i = 0; i < PHASES; ++i) {
+                best.time[i] = std::min(best.time[i], m.time[i]);
+            }
+        }
+
+        std::string res = "==== " + std::to_string(realLines) + " lines, " + std::to_string(runs) + " run(s), peak RSS "
+                          + std::to_string(Stats::peakMemoryKiB()) + " KiB ====\n";
+        res += padRight("phase", 20) + padLeft("units", 16) + padLeft("time(ms)", 12) + padLeft("units/s", 14)
+               + padLeft("allocs", 12) + padLeft("alloc KiB", 12) + padLeft("allocs/unit", 13) + '\n';
+        for (std::size_t i = 0; i < PHASES; ++i) {
+            auto units = best.units.*phases[i].count;
+            auto ms = std::chrono::duration<double, std::milli>(best.time[i]).count();
+            auto &allocations = best.allocations[i];
+            res += padRight(phases[i].name, 20)
+                   + padLeft(std::to_string(units) + " " + phases[i].unit, 16)
+                   + padLeft(format("%.3f", ms), 12)
+                   + padLeft(ms > 0 ? format("%.0f", static_cast<double>(units) * 1000 / ms) : "-", 14)
+                   + padLeft(Stats::ALLOCATIONS_COUNTED ? std::to_string(allocations.count) : "-", 12)
+                   + padLeft(Stats::ALLOCATIONS_COUNTED ? std::to_string(allocations.bytes / 1024) : "-", 12)
+                   + padLeft(Stats::ALLOCATIONS_COUNTED && units > 0
+                                     ? format("%.2f", static_cast<double>(allocations.count) / static_cast<double>(units))
+                                     : "-", 13)
+                   + '\n';
+        }
+        out << res << '\n';
+        out.flush();
+
+        sizes.push_back(realLines);
+        measures.push_back(best);
+    }
+    Stats::countAllocations(false);
+
+    // ns per unit stays flat for a linear phase, "!" marks one twice as slow per unit as on the size before
+    std::string res = "==== ns per unit ====\n" + padRight("phase", 20);
+    for (auto lines: sizes) {
+        res += padLeft(std::to_string(lines), 12);
+    }
+    res += '\n';
+    for (std::size_t i = 0; i < PHASES; ++i) {
+        res += padRight(phases[i].name, 20);
+        for (std::size_t s = 0; s < measures.size(); ++s) {
+            auto ns = nsPer(measures[s].time[i], measures[s].units.*phases[i].count);
+            bool superLinear = false;
+            if (s > 0) {
+                auto prev = nsPer(measures[s - 1].time[i], measures[s - 1].units.*phases[i].count);
+                superLinear = prev > 0 && ns > 2 * prev;
+            }
+            res += padLeft(format("%.1f", ns) + (superLinear ? "!" : ""), 12);
+        }
+        res += '\n';
+    }
+    out << res;
+}
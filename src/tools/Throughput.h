@@ -0,0 +1,38 @@
+//
+// Created by Steel_Shadow on 2026/10/19.
+//
+
+#ifndef COMPILER_THROUGHPUT_H
+#define COMPILER_THROUGHPUT_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tools/Generator.h"
+
+// Compile-throughput microbenchmark: each phase of compile() on generated sources of growing size,
+// timed by the Stats::Timer of the phase, with the allocations it makes.
+// A phase whose time per unit grows with the size is super-linear, e.g. a peephole rescanning the function.
+namespace Throughput {
+// 1K to 10M lines, "--throughput --full"
+// compiling takes about 7 KiB per line of Generator, so 1M lines need ~7 GiB and 10M ~70 GiB,
+// hence they are not in the default sizes
+const std::vector<std::size_t> FULL_LINES{1'000, 10'000, 100'000, 1'000'000, 10'000'000};
+
+struct Config {
+    // rough line counts of the sources, those of FULL_LINES that fit in a usual machine
+    std::vector<std::size_t> lines{1'000, 10'000, 100'000};
+    // the sources are written here as <lines>.txt
+    std::string dir = "throughput_out/";
+    // the shape of the sources, Generator::Config::lines is set from lines
+    Generator::Config generator;
+};
+
+// one table per size, then the time per unit of each phase across the sizes
+// throw std::runtime_error if a source does not compile
+void run(std::ostream &out, const Config &config);
+} // namespace Throughput
+
+#endif